@@ -0,0 +1,59 @@
+// ipc/histogram.h
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <array>
+#include <algorithm>
+#include <limits>
+
+// 非负整数样本（延迟的 tick 数、队列深度）的定长直方图：0..63 每个值一个桶，
+// 更大的值按 2 的幂分桶。记录 O(1)、不分配内存，百分位数在桶内取上界（不超过最大值）
+class Histogram {
+public:
+    void record(long long value) {
+        if (value < 0) value = 0;
+        buckets[bucketOf(value)]++;
+        samples++;
+        sum += value;
+        maxValue = std::max(maxValue, value);
+    }
+
+    long long count() const { return samples; }
+    long long max() const { return maxValue; }
+    double mean() const { return samples > 0 ? static_cast<double>(sum) / static_cast<double>(samples) : 0.0; }
+
+    // p 取 0..100
+    long long percentile(double p) const {
+        if (samples == 0) return 0;
+        long long rank = std::max(1LL, static_cast<long long>(p / 100.0 * static_cast<double>(samples) + 0.999999));
+        long long seen = 0;
+        for (int i = 0; i < BUCKETS; ++i) {
+            seen += buckets[static_cast<size_t>(i)];
+            if (seen >= rank) return std::min(upperBound(i), maxValue);
+        }
+        return maxValue;
+    }
+
+private:
+    static constexpr int LINEAR = 64;
+    static constexpr int BUCKETS = LINEAR + 57; // 最高位为 6..62 的值各一个桶
+
+    static int bucketOf(long long value) {
+        if (value < LINEAR) return static_cast<int>(value);
+        int bit = 6;
+        while ((value >> (bit + 1)) != 0) bit++;
+        return LINEAR + bit - 6;
+    }
+    static long long upperBound(int bucket) {
+        if (bucket < LINEAR) return bucket;
+        int bit = bucket - LINEAR + 6;
+        return bit >= 62 ? std::numeric_limits<long long>::max() : (2LL << bit) - 1;
+    }
+
+    std::array<long long, BUCKETS> buckets{};
+    long long samples = 0;
+    long long sum = 0;
+    long long maxValue = 0;
+};
+
+#endif // HISTOGRAM_H
@@ -1,44 +1,256 @@
 #include "ipc.h"
 #include <iomanip>
+#include <cstring>
+#include <algorithm>
 
-bool IPCManager::sendMessage(const std::string& fromPid, const std::string& toPid, const std::string& content) {
-    Message msg;
-    msg.senderPid = fromPid;
-    msg.content = content;
-    msg.timestamp = 0; // 也可以传入 Scheduler 的全局时间，这里暂存0
+void Message::set(const std::string& sender, const std::string& text, int time) {
+    size_t n = sender.copy(senderPid, MAX_PID - 1);
+    senderPid[n] = '\0';
+    length = static_cast<std::uint16_t>(text.copy(content, MAX_CONTENT));
+    timestamp = time;
+}
 
-    messageQueues[toPid].push(msg);
-    std::cout << "[IPC] Message sent from " << fromPid << " to " << toPid << ".\n";
+bool IPCManager::openMailbox(const std::string& pid, int capacity) {
+    if (capacity <= 0) return false;
+    mailboxes.try_emplace(pid, capacity);
     return true;
 }
 
-bool IPCManager::receiveMessage(const std::string& targetPid, Message& outMsg) {
-    if (messageQueues.find(targetPid) == messageQueues.end() || messageQueues[targetPid].empty()) {
-        return false;
+// 邮箱已存在时只做一次查找（find 可与其他线程的 find 并发）
+IPCManager::Mailbox& IPCManager::mailboxFor(const std::string& pid) {
+    auto it = mailboxes.find(pid);
+    if (it == mailboxes.end()) it = mailboxes.try_emplace(pid, DEFAULT_CAPACITY).first;
+    return it->second;
+}
+
+IpcStatus IPCManager::sendMessage(const std::string& fromPid, const std::string& toPid, const std::string& content, int now) {
+    if (content.length() > static_cast<size_t>(Message::MAX_CONTENT)) return IpcStatus::TooLong;
+    Mailbox& box = mailboxFor(toPid);
+
+    Message msg;
+    msg.set(fromPid, content, now);
+    if (!box.ring.tryPush(msg)) {
+        box.rejected.fetch_add(1, std::memory_order_relaxed);
+        return IpcStatus::WouldBlock; // 背压：满了就让发送者自己决定重试或等待
     }
+    box.sent.fetch_add(1, std::memory_order_relaxed);
+    size_t depth = box.ring.size();
+    size_t high = box.highWater.load(std::memory_order_relaxed);
+    while (depth > high && !box.highWater.compare_exchange_weak(high, depth, std::memory_order_relaxed)) {}
+    return IpcStatus::Ok;
+}
+
+IpcStatus IPCManager::receiveMessage(const std::string& targetPid, Message& outMsg, int now) {
+    auto it = mailboxes.find(targetPid);
+    if (it == mailboxes.end()) return IpcStatus::NoMailbox;
+    Mailbox& box = it->second;
+    if (!box.ring.tryPop(outMsg)) return IpcStatus::WouldBlock;
+    box.received.fetch_add(1, std::memory_order_relaxed);
+    recordDelivery(box, outMsg, now, box.ring.size() + 1);
+    return IpcStatus::Ok;
+}
+
+void IPCManager::recordDelivery(Mailbox& box, const Message& msg, int now, std::size_t depth) {
+    box.latency.record(now - msg.timestamp);
+    box.depth.record(static_cast<long long>(depth));
+}
+
+const Histogram& IPCManager::getLatency(const std::string& pid) const {
+    static const Histogram empty;
+    auto it = mailboxes.find(pid);
+    return it != mailboxes.end() ? it->second.latency : empty;
+}
+
+bool IPCManager::handOff(Scheduler& scheduler, const std::string& pid, Mailbox& box, const Message& msg) {
+    PCB* proc = box.receiver;
+    if (!proc) return false;
+    box.receiver = nullptr;
+    // 阻塞后被别处唤醒过（wake 命令、同步对象、I/O 完成），即使此刻又阻塞了也不再等这条消息
+    if (!proc->waitingOn(box.receiverToken)) return false;
 
-    // 取出队首消息
-    outMsg = messageQueues[targetPid].front();
-    messageQueues[targetPid].pop();
-    
-    std::cout << "[IPC] Process " << targetPid << " received message from " << outMsg.senderPid << ".\n";
+    int now = scheduler.getCurrentTime();
+    box.sent.fetch_add(1, std::memory_order_relaxed);
+    box.received.fetch_add(1, std::memory_order_relaxed);
+    box.receiveWaitTicks += now - box.receiverSince;
+    recordDelivery(box, msg, now, 1); // 不经队列，直接交付
+    std::cout << "[IPC] Message sent from " << msg.sender() << " to " << pid << ".\n";
+    std::cout << "[IPC] Process " << pid << " received message from " << msg.sender() << " after waiting "
+              << now - box.receiverSince << " tick(s): " << msg.text() << "\n";
+    scheduler.wakeProcess(proc);
     return true;
 }
 
+void IPCManager::admitSender(Scheduler& scheduler, Mailbox& box) {
+    int now = scheduler.getCurrentTime();
+    while (!box.senders.empty()) {
+        Mailbox::PendingSend pending = box.senders.front();
+        box.senders.pop_front();
+        if (!pending.proc->waitingOn(pending.token)) continue; // 发送者已被别处唤醒，放弃这次发送
+        box.ring.tryPush(pending.msg); // 刚取走一条，必有空位
+        box.sent.fetch_add(1, std::memory_order_relaxed);
+        box.sendWaitTicks += now - pending.since;
+        std::cout << "[IPC] Mailbox has room again, message from " << pending.proc->pid << " queued after waiting "
+                  << now - pending.since << " tick(s).\n";
+        scheduler.wakeProcess(pending.proc);
+        return;
+    }
+}
+
+IpcStatus IPCManager::send(Scheduler& scheduler, const std::string& toPid, const std::string& content) {
+    PCB* cur = scheduler.getRunningProcess();
+    if (!cur) return IpcStatus::NoProcess;
+    if (content.length() > static_cast<size_t>(Message::MAX_CONTENT)) return IpcStatus::TooLong;
+    Mailbox& box = mailboxFor(toPid);
+    int now = scheduler.getCurrentTime();
+    Message msg;
+    msg.set(cur->pid, content, now);
+
+    if (handOff(scheduler, toPid, box, msg)) return IpcStatus::Ok;
+    if (box.ring.tryPush(msg)) {
+        box.sent.fetch_add(1, std::memory_order_relaxed);
+        box.highWater.store(std::max(box.highWater.load(std::memory_order_relaxed), box.ring.size()), std::memory_order_relaxed);
+        std::cout << "[IPC] Message sent from " << cur->pid << " to " << toPid << ".\n";
+        return IpcStatus::Ok;
+    }
+
+    // 邮箱满：带着消息阻塞，接收者腾出空位时再放入
+    box.blockedSends++;
+    std::cout << "[IPC] Mailbox of " << toPid << " is full, " << cur->pid << " waits for room.\n";
+    box.senders.push_back({cur, msg, now, scheduler.blockCurrentProcess()});
+    return IpcStatus::Blocked;
+}
+
+IpcStatus IPCManager::receive(Scheduler& scheduler, Message& outMsg) {
+    PCB* cur = scheduler.getRunningProcess();
+    if (!cur) return IpcStatus::NoProcess;
+    Mailbox& box = mailboxFor(cur->pid);
+    int now = scheduler.getCurrentTime();
+    if (box.ring.tryPop(outMsg)) {
+        box.received.fetch_add(1, std::memory_order_relaxed);
+        recordDelivery(box, outMsg, now, box.ring.size() + 1);
+        std::cout << "[IPC] Process " << cur->pid << " received message from " << outMsg.sender() << ".\n";
+        admitSender(scheduler, box);
+        return IpcStatus::Ok;
+    }
+
+    // 邮箱空：阻塞，下一条消息到达时由发送者直接交付并唤醒
+    box.receiver = cur;
+    box.receiverSince = now;
+    box.blockedReceives++;
+    std::cout << "[IPC] Mailbox of " << cur->pid << " is empty, waiting for a message.\n";
+    box.receiverToken = scheduler.blockCurrentProcess();
+    return IpcStatus::Blocked;
+}
+
 bool IPCManager::hasMessage(const std::string& targetPid) const {
-    auto it = messageQueues.find(targetPid);
-    return (it != messageQueues.end() && !it->second.empty());
+    auto it = mailboxes.find(targetPid);
+    return (it != mailboxes.end() && !it->second.ring.empty());
+}
+
+bool IPCManager::createPipe(const std::string& name, int capacity, int now) {
+    if (capacity <= 0) return false;
+    return pipes.try_emplace(name, capacity, now).second;
+}
+
+bool IPCManager::removePipe(const std::string& name) {
+    return pipes.erase(name) != 0U;
+}
+
+int IPCManager::writePipe(const std::string& name, const std::string& data, int now) {
+    auto it = pipes.find(name);
+    if (it == pipes.end()) return -1;
+    return it->second.write(data.data(), static_cast<int>(data.size()), now);
+}
+
+int IPCManager::readPipe(const std::string& name, int len, std::string& out, int now) {
+    auto it = pipes.find(name);
+    if (it == pipes.end() || len < 0) return -1;
+    out.resize(static_cast<size_t>(len));
+    int n = it->second.read(&out[0], len, now);
+    out.resize(static_cast<size_t>(n));
+    return n;
+}
+
+void IPCManager::subscribe(const std::string& topic, const std::string& pid, int depth, int now) {
+    topics.try_emplace(topic, now).first->second.subscribe(pid, depth);
+}
+
+bool IPCManager::unsubscribe(const std::string& topic, const std::string& pid) {
+    auto it = topics.find(topic);
+    return it != topics.end() && it->second.unsubscribe(pid);
+}
+
+int IPCManager::publish(const std::string& topic, const std::string& sender, const std::string& data, int now) {
+    auto it = topics.find(topic);
+    if (it == topics.end()) return -1;
+    return it->second.publish(sender, data, now);
+}
+
+IpcStatus IPCManager::fetch(const std::string& topic, const std::string& pid, Topic::Payload& out, int now) {
+    auto it = topics.find(topic);
+    if (it == topics.end() || !it->second.hasSubscriber(pid)) return IpcStatus::NoMailbox;
+    return it->second.fetch(pid, out, now) ? IpcStatus::Ok : IpcStatus::WouldBlock;
 }
 
-void IPCManager::printStatus() const {
+void IPCManager::printStatus(int now) const {
     std::cout << "\n--- IPC Message Queues ---\n";
-    if (messageQueues.empty()) {
-        std::cout << "(No messages pending)\n";
+    if (mailboxes.empty() && pipes.empty() && topics.empty()) {
+        std::cout << "(No channels)\n";
+    }
+    for (const auto& pair : mailboxes) {
+        const Mailbox& box = pair.second;
+        std::cout << "Process " << pair.first << ": " << box.ring.size() << "/" << box.ring.capacity()
+                  << " unread message(s) | sent " << box.sent.load() << ", received " << box.received.load()
+                  << ", rejected (full) " << box.rejected.load() << ", high-water " << box.highWater.load() << "\n";
+        if (box.latency.count() == 0 && box.blockedReceives == 0 && box.blockedSends == 0) continue;
+        std::cout << std::fixed << std::setprecision(2);
+        size_t senders = 0;
+        for (const Mailbox::PendingSend& pending : box.senders) {
+            if (pending.proc->waitingOn(pending.token)) senders++;
+        }
+        std::cout << "    Waiting: " << (box.receiver && box.receiver->waitingOn(box.receiverToken) ? "receiver, " : "")
+                  << senders << " sender(s) | Blocked receives: " << box.blockedReceives << " (mean wait "
+                  << (box.blockedReceives > 0 ? static_cast<double>(box.receiveWaitTicks) / box.blockedReceives : 0.0)
+                  << ") | Blocked sends: " << box.blockedSends << " (mean wait "
+                  << (box.blockedSends > 0 ? static_cast<double>(box.sendWaitTicks) / box.blockedSends : 0.0)
+                  << ")\n";
+        std::cout << "    Latency (ticks): mean " << box.latency.mean() << ", p50 " << box.latency.percentile(50)
+                  << ", p99 " << box.latency.percentile(99) << ", max " << box.latency.max() << " | Depth at receive: mean "
+                  << box.depth.mean() << ", p50 " << box.depth.percentile(50) << ", p99 " << box.depth.percentile(99)
+                  << ", max " << box.depth.max() << "\n";
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6);
     }
-    for (const auto& pair : messageQueues) {
-        if (!pair.second.empty()) {
-            std::cout << "Process " << pair.first << ": " << pair.second.size() << " unread message(s).\n";
+
+    std::cout << std::fixed << std::setprecision(2);
+    for (const auto& pair : pipes) {
+        const Pipe& pipe = pair.second;
+        int elapsed = std::max(1, now - pipe.createdAt);
+        std::cout << "Pipe '" << pair.first << "': " << pipe.size() << "/" << pipe.capacity() << " byte(s) buffered"
+                  << " (high-water " << pipe.highWater << ") | written " << pipe.bytesWritten << " B in " << pipe.writes
+                  << " write(s) (" << pipe.partialWrites << " partial, " << pipe.fullWrites << " full) | read "
+                  << pipe.bytesRead << " B in " << pipe.reads << " read(s) (" << pipe.emptyReads << " empty) | "
+                  << static_cast<double>(pipe.bytesRead) / elapsed << " B/tick\n";
+    }
+    for (const auto& pair : topics) {
+        const Topic& topic = pair.second;
+        int elapsed = std::max(1, now - topic.createdAt);
+        std::cout << "Topic '" << pair.first << "': " << topic.getSubscribers().size() << " subscriber(s) | published "
+                  << topic.published << " (" << topic.bytesPublished << " B), delivered " << topic.deliveries << " ("
+                  << static_cast<double>(topic.deliveries) / elapsed << "/tick) | " << topic.bytesShared
+                  << " B shared instead of copied\n";
+        for (const auto& sub : topic.getSubscribers()) {
+            const Topic::Subscriber& s = sub.second;
+            std::cout << "    " << sub.first << ": " << s.queue.size() << "/" << s.depth << " queued (high-water "
+                      << s.highWater << ") | received " << s.received << ", dropped (full) " << s.dropped;
+            if (s.latency.count() > 0) {
+                std::cout << " | latency p50 " << s.latency.percentile(50) << ", p99 " << s.latency.percentile(99)
+                          << ", max " << s.latency.max();
+            }
+            std::cout << "\n";
         }
     }
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
     std::cout << "--------------------------\n";
-}
\ No newline at end of file
+}
@@ -2,36 +2,132 @@
 #define IPC_H
 
 #include <string>
-#include <queue>
-#include <map>
+#include <unordered_map>
 #include <iostream>
 #include <vector>
+#include <cstdint>
+#include <atomic>
+#include <deque>
+#include <map>
+#include "ring_buffer.h"
+#include "histogram.h"
+#include "pipe.h"
+#include "topic.h"
+#include "../scheduler/scheduler.h"
 
-// 消息结构体
+// 消息结构体：发送者与内容都内联存放在定长数组里，收发时不分配内存
 struct Message {
-    std::string senderPid;
-    std::string content;
+    static constexpr int MAX_PID = 16;      // 含结尾 '\0'
+    static constexpr int MAX_CONTENT = 100;
+
+    char senderPid[MAX_PID];
+    char content[MAX_CONTENT];
+    std::uint16_t length;
     int timestamp;
+
+    // 超出容量的部分被截断（sendMessage 会先拒绝过长的内容）
+    void set(const std::string& sender, const std::string& text, int time);
+    std::string sender() const { return senderPid; }
+    std::string text() const { return std::string(content, length); }
+};
+
+// 发送/接收的结果
+enum class IpcStatus {
+    Ok,
+    WouldBlock, // 邮箱已满（发送）或为空（接收）
+    TooLong,    // 内容超过 Message::MAX_CONTENT
+    NoMailbox,
+    Blocked,    // 阻塞式收发：当前进程已阻塞，稍后由对方唤醒
+    NoProcess   // 阻塞式收发：没有正在运行的进程
 };
 
 class IPCManager {
 public:
-    // 发送消息：from -> to
-    bool sendMessage(const std::string& fromPid, const std::string& toPid, const std::string& content);
+    static constexpr int DEFAULT_CAPACITY = 64;
+
+    // 创建（或确认存在）pid 的邮箱；容量向上取 2 的幂，已存在的邮箱容量不变
+    bool openMailbox(const std::string& pid, int capacity = DEFAULT_CAPACITY);
+
+    // 发送消息：from -> to（收件箱不存在时按默认容量创建）。邮箱满时返回 WouldBlock，消息不入队。
+    // now 是入队时刻，记入消息的时间戳
+    IpcStatus sendMessage(const std::string& fromPid, const std::string& toPid, const std::string& content, int now = 0);
 
-    // 接收消息：获取发给 targetPid 的第一条消息
-    // return: 如果有消息返回 true，并填充 outMsg；否则返回 false
-    bool receiveMessage(const std::string& targetPid, Message& outMsg);
+    // 接收消息：把发给 targetPid 的第一条消息移出到 outMsg，没有消息返回 WouldBlock。
+    // now 是出队时刻，与时间戳之差记入该邮箱的延迟直方图（同一邮箱只能有一个接收线程）
+    IpcStatus receiveMessage(const std::string& targetPid, Message& outMsg, int now = 0);
+
+    // 阻塞式收发（由当前运行的进程发起），与调度器配合：
+    //  - receive：邮箱为空时当前进程阻塞，下一条发给它的消息直接交给它并唤醒它
+    //  - send：邮箱满时当前进程带着消息阻塞，接收者取走一条后把它的消息放入邮箱并唤醒它
+    // 每次只唤醒一个等待者。上面的非阻塞接口不与调度器交互
+    IpcStatus send(Scheduler& scheduler, const std::string& toPid, const std::string& content);
+    IpcStatus receive(Scheduler& scheduler, Message& outMsg);
 
     // 查看是否有消息待处理
     bool hasMessage(const std::string& targetPid) const;
 
-    // debug: 打印所有消息队列状态
-    void printStatus() const;
+    // 命名管道：字节流，读写可以只完成一部分，返回实际字节数；管道不存在或 len 为负返回 -1
+    bool createPipe(const std::string& name, int capacity, int now);
+    bool removePipe(const std::string& name);
+    int writePipe(const std::string& name, const std::string& data, int now);
+    int readPipe(const std::string& name, int len, std::string& out, int now);
+
+    // 发布/订阅：主题在第一次订阅时创建。publish 返回收到的订阅者数，主题不存在返回 -1；
+    // fetch 在未订阅时返回 NoMailbox，队列为空返回 WouldBlock
+    void subscribe(const std::string& topic, const std::string& pid, int depth, int now);
+    bool unsubscribe(const std::string& topic, const std::string& pid);
+    int publish(const std::string& topic, const std::string& sender, const std::string& data, int now);
+    IpcStatus fetch(const std::string& topic, const std::string& pid, Topic::Payload& out, int now);
+
+    // 邮箱的消息延迟（入队到出队的时间），邮箱不存在时返回空直方图
+    const Histogram& getLatency(const std::string& pid) const;
+
+    // debug: 打印所有消息队列、管道与主题的状态（吞吐量按 now 计算）
+    void printStatus(int now = 0) const;
 
 private:
-    // 每个进程都有一个专属的收件箱（队列）
-    std::map<std::string, std::queue<Message>> messageQueues;
+    // 每个进程都有一个专属的收件箱：定长无锁环形队列，多个发送者可以并发投递。
+    // 邮箱只在首次使用时创建；已创建的邮箱可以被多个线程同时收发
+    struct Mailbox {
+        explicit Mailbox(int capacity) : ring(static_cast<std::size_t>(capacity)) {}
+        RingBuffer<Message> ring;
+        std::atomic<long long> sent{0};
+        std::atomic<long long> received{0};
+        std::atomic<long long> rejected{0}; // 满时被拒绝的发送
+        std::atomic<std::size_t> highWater{0};
+
+        // 阻塞式收发的等待者（只在主线程上访问）：至多一个接收者（邮箱的主人），发送者按 FIFO 排队
+        struct PendingSend {
+            PCB* proc;
+            Message msg;
+            int since;
+            unsigned long long token; // 阻塞时得到的等待令牌
+        };
+        PCB* receiver = nullptr;
+        unsigned long long receiverToken = 0;
+        int receiverSince = 0;
+        std::deque<PendingSend> senders;
+        long long blockedReceives = 0;
+        long long blockedSends = 0;
+        long long receiveWaitTicks = 0;
+        long long sendWaitTicks = 0;
+
+        // 只由接收方（单线程）更新：每条消息从入队到出队的时间，以及出队时队列中的消息数（含这一条）
+        Histogram latency;
+        Histogram depth;
+    };
+
+    Mailbox& mailboxFor(const std::string& pid);
+    // 接收者正阻塞在 box 上时把消息直接交给它并唤醒，返回是否交付
+    bool handOff(Scheduler& scheduler, const std::string& pid, Mailbox& box, const Message& msg);
+    // 接收者取走一条消息后，把排在最前的阻塞发送者的消息放入邮箱并唤醒它
+    void admitSender(Scheduler& scheduler, Mailbox& box);
+    static void recordDelivery(Mailbox& box, const Message& msg, int now, std::size_t depth);
+
+    // unordered_map 按节点存放，邮箱创建后地址不变
+    std::unordered_map<std::string, Mailbox> mailboxes;
+    std::map<std::string, Pipe> pipes;
+    std::map<std::string, Topic> topics;
 };
 
-#endif // IPC_H
\ No newline at end of file
+#endif // IPC_H
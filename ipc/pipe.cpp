@@ -0,0 +1,45 @@
+#include "pipe.h"
+#include <algorithm>
+#include <cstring>
+
+Pipe::Pipe(int capacity, int now) : createdAt(now), lastActive(now), buffer(static_cast<std::size_t>(capacity)) {}
+
+int Pipe::write(const char* data, int len, int now) {
+    if (len <= 0) return 0;
+    writes++;
+    lastActive = now;
+    std::size_t n = std::min(static_cast<std::size_t>(len), buffer.size() - count);
+    if (n == 0) {
+        fullWrites++;
+        return 0;
+    }
+    if (n < static_cast<std::size_t>(len)) partialWrites++;
+
+    // 尾部可能绕回缓冲区开头：最多分两段拷贝
+    std::size_t tail = (head + count) % buffer.size();
+    std::size_t first = std::min(n, buffer.size() - tail);
+    std::memcpy(&buffer[tail], data, first);
+    std::memcpy(&buffer[0], data + first, n - first);
+    count += n;
+    bytesWritten += static_cast<long long>(n);
+    highWater = std::max(highWater, size());
+    return static_cast<int>(n);
+}
+
+int Pipe::read(char* out, int len, int now) {
+    if (len <= 0) return 0;
+    reads++;
+    lastActive = now;
+    std::size_t n = std::min(static_cast<std::size_t>(len), count);
+    if (n == 0) {
+        emptyReads++;
+        return 0;
+    }
+    std::size_t first = std::min(n, buffer.size() - head);
+    std::memcpy(out, &buffer[head], first);
+    std::memcpy(out + first, &buffer[0], n - first);
+    head = (head + n) % buffer.size();
+    count -= n;
+    bytesRead += static_cast<long long>(n);
+    return static_cast<int>(n);
+}
@@ -0,0 +1,41 @@
+// ipc/pipe.h
+#ifndef PIPE_H
+#define PIPE_H
+
+#include <vector>
+#include <cstddef>
+
+// 字节流管道：固定大小的内核缓冲区（字节环形队列），没有消息边界。
+// 写入只放得下一部分时写入能放下的部分并返回实际字节数，读出同理；满/空时返回 0，由调用者决定重试
+class Pipe {
+public:
+    static constexpr int DEFAULT_CAPACITY = 4096;
+
+    Pipe(int capacity, int now);
+
+    // 返回实际写入 / 读出的字节数；len <= 0 时什么也不做，也不计入统计
+    int write(const char* data, int len, int now);
+    int read(char* out, int len, int now);
+
+    int size() const { return static_cast<int>(count); }
+    int capacity() const { return static_cast<int>(buffer.size()); }
+
+    // 统计
+    long long bytesWritten = 0;
+    long long bytesRead = 0;
+    long long writes = 0;
+    long long reads = 0;
+    long long partialWrites = 0; // 只写入了一部分
+    long long fullWrites = 0;    // 缓冲区满，一个字节也没写入
+    long long emptyReads = 0;
+    int highWater = 0;
+    int createdAt = 0;
+    int lastActive = 0;
+
+private:
+    std::vector<char> buffer;
+    std::size_t head = 0;  // 下一个要读的字节
+    std::size_t count = 0; // 缓冲区内的字节数
+};
+
+#endif // PIPE_H
@@ -0,0 +1,94 @@
+// ipc/ring_buffer.h
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <utility>
+
+// 定长无锁环形队列（Vyukov 有界队列）：每个槽带一个序号，生产者与消费者各自用 CAS 推进位置，
+// 多个生产者、一个消费者（MPSC，也兼容 SPSC）可以并发访问而不加锁。
+// 容量在构造时确定（向上取 2 的幂），之后收发都不再分配内存；满时 tryPush 直接返回 false。
+template <typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(std::size_t capacity) {
+        std::size_t size = 2;
+        while (size < capacity) size <<= 1;
+        mask = size - 1;
+        cells.reset(new Cell[size]);
+        for (std::size_t i = 0; i < size; ++i) cells[i].seq.store(i, std::memory_order_relaxed);
+        enqueuePos.store(0, std::memory_order_relaxed);
+        dequeuePos.store(0, std::memory_order_relaxed);
+    }
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    // 入队，队列满时返回 false
+    template <typename U>
+    bool tryPush(U&& value) {
+        Cell* cell;
+        std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells[pos & mask];
+            std::size_t seq = cell->seq.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                // 槽空闲：抢到这个位置就写入
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false; // 槽里还是上一圈未取走的元素：队列已满
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed); // 被其他生产者抢先
+            }
+        }
+        cell->data = std::forward<U>(value);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 出队（移出元素），队列空时返回 false
+    bool tryPop(T& out) {
+        Cell* cell;
+        std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells[pos & mask];
+            std::size_t seq = cell->seq.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false; // 生产者还没写到这里：队列为空
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        out = std::move(cell->data);
+        cell->seq.store(pos + mask + 1, std::memory_order_release); // 留给下一圈的生产者
+        return true;
+    }
+
+    std::size_t capacity() const { return mask + 1; }
+    // 当前元素数（并发时只是近似值）
+    std::size_t size() const {
+        std::size_t enq = enqueuePos.load(std::memory_order_relaxed);
+        std::size_t deq = dequeuePos.load(std::memory_order_relaxed);
+        return enq > deq ? enq - deq : 0;
+    }
+    bool empty() const { return size() == 0; }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> seq;
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    std::size_t mask = 0;
+    // 生产者与消费者的位置放在不同缓存行，避免互相使对方的缓存行失效
+    alignas(64) std::atomic<std::size_t> enqueuePos;
+    alignas(64) std::atomic<std::size_t> dequeuePos;
+};
+
+#endif // RING_BUFFER_H
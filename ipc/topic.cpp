@@ -0,0 +1,42 @@
+#include "topic.h"
+#include <algorithm>
+
+void Topic::subscribe(const std::string& pid, int depth) {
+    subscribers[pid].depth = depth;
+}
+
+bool Topic::unsubscribe(const std::string& pid) {
+    return subscribers.erase(pid) != 0U;
+}
+
+int Topic::publish(const std::string& sender, const std::string& data, int now) {
+    Payload payload = std::make_shared<const Publication>(Publication{sender, data, now});
+    int fanout = 0;
+    for (auto& pair : subscribers) {
+        Subscriber& sub = pair.second;
+        if (static_cast<int>(sub.queue.size()) >= sub.depth) {
+            sub.dropped++;
+            continue;
+        }
+        sub.queue.push_back(payload); // 只增加引用计数
+        sub.highWater = std::max(sub.highWater, static_cast<int>(sub.queue.size()));
+        fanout++;
+    }
+    published++;
+    deliveries += fanout;
+    bytesPublished += static_cast<long long>(data.size());
+    if (fanout > 1) bytesShared += static_cast<long long>(data.size()) * (fanout - 1);
+    lastActive = now;
+    return fanout;
+}
+
+bool Topic::fetch(const std::string& pid, Payload& out, int now) {
+    auto it = subscribers.find(pid);
+    if (it == subscribers.end() || it->second.queue.empty()) return false;
+    out = std::move(it->second.queue.front());
+    it->second.queue.pop_front();
+    it->second.received++;
+    it->second.latency.record(now - out->timestamp);
+    lastActive = now;
+    return true;
+}
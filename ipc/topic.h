@@ -0,0 +1,60 @@
+// ipc/topic.h
+#ifndef TOPIC_H
+#define TOPIC_H
+
+#include <string>
+#include <memory>
+#include <deque>
+#include <map>
+#include "histogram.h"
+
+// 发布的一条消息。所有订阅者的队列里存的都是指向同一份内容的引用计数指针，
+// 发布一次只分配一份，最后一个订阅者取走后才释放
+struct Publication {
+    std::string sender;
+    std::string data;
+    int timestamp;
+};
+
+// 发布/订阅主题：一次发布扇出给 N 个订阅者，每个订阅者有自己的有界队列，
+// 队列满的订阅者丢弃这条消息（不影响其他订阅者）
+class Topic {
+public:
+    using Payload = std::shared_ptr<const Publication>;
+    static constexpr int DEFAULT_DEPTH = 16;
+
+    explicit Topic(int now) : createdAt(now), lastActive(now) {}
+
+    // 已订阅时只更新队列上限
+    void subscribe(const std::string& pid, int depth);
+    bool unsubscribe(const std::string& pid);
+    bool hasSubscriber(const std::string& pid) const { return subscribers.count(pid) != 0; }
+
+    // 返回实际放入队列的订阅者数
+    int publish(const std::string& sender, const std::string& data, int now);
+    // 取出 pid 的下一条消息，没有消息返回 false
+    bool fetch(const std::string& pid, Payload& out, int now);
+
+    struct Subscriber {
+        std::deque<Payload> queue;
+        int depth = DEFAULT_DEPTH;
+        long long received = 0;
+        long long dropped = 0; // 队列满而没收到的发布
+        int highWater = 0;
+        Histogram latency; // 发布到被取走的时间
+    };
+    const std::map<std::string, Subscriber>& getSubscribers() const { return subscribers; }
+
+    // 统计
+    long long published = 0;
+    long long deliveries = 0;    // 放入订阅者队列的次数（扇出总数）
+    long long bytesPublished = 0;
+    long long bytesShared = 0;   // 因共享内容而省去的拷贝字节数
+    int createdAt = 0;
+    int lastActive = 0;
+
+private:
+    std::map<std::string, Subscriber> subscribers;
+};
+
+#endif // TOPIC_H
@@ -5,14 +5,66 @@
 #include <map>
 #include <limits>
 #include <sstream>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <fstream>
 
 // 请确保这些头文件都在对应的文件夹里
 #include "scheduler/scheduler.h"
 #include "memory_manager/memory_manager.h"
 #include "sync/semaphore.h"
+#include "sync/sync_table.h"
 #include "storage/storage.h"
+#include "storage/async_io.h"
 #include "ipc/ipc.h"
 
+// 丢弃一切写入的输出缓冲区：批处理的非 full 级别把 std::cout 指向它。
+// 字符在一个小缓冲区里循环覆盖，流始终处于正常状态
+class NullBuffer : public std::streambuf {
+public:
+    NullBuffer() { setp(scratch, scratch + sizeof(scratch)); }
+
+protected:
+    int overflow(int ch) override {
+        setp(scratch, scratch + sizeof(scratch));
+        return traits_type::not_eof(ch);
+    }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+
+private:
+    char scratch[256];
+};
+
+NullBuffer nullOutput;
+
+// std::cout 当前是否被静音（此时不必格式化大段输出）
+bool outputMuted() {
+    return std::cout.rdbuf() == &nullOutput;
+}
+
+// 在作用域内把 std::cout 指向 nullOutput；restore() 或离开作用域（任何返回路径）时恢复原缓冲区
+class MutedOutput {
+public:
+    explicit MutedOutput(bool mute) : saved(mute ? std::cout.rdbuf(&nullOutput) : nullptr) {}
+    ~MutedOutput() { restore(); }
+    MutedOutput(const MutedOutput&) = delete;
+    MutedOutput& operator=(const MutedOutput&) = delete;
+
+    void restore() {
+        if (saved) std::cout.rdbuf(saved);
+        saved = nullptr;
+    }
+
+private:
+    std::streambuf* saved;
+};
+
 // 状态转字符串
 std::string stateToString(ProcessState s) {
     switch (s) {
@@ -27,9 +79,14 @@ std::string stateToString(ProcessState s) {
 }
 
 // === 核心功能：打印系统当前详细状态 ===
-void printSystemStatus(Scheduler& scheduler, const std::map<std::string, int*>& memMap) {
+void printSystemStatus(Scheduler& scheduler, const std::map<std::string, int*>& memMap, const MemoryManager& mm) {
+    if (outputMuted()) return; // 批处理关闭了输出：整张进程表都不必格式化
     const auto& procs = scheduler.getAllProcesses();
     std::cout << "\n===== System Status (Time: " << scheduler.getCurrentTime() << ") =====\n";
+    std::cout << std::fixed << std::setprecision(1) << "CPU Utilization: " << scheduler.getCpuUtilization()
+              << "% (" << scheduler.getBusyTime() << "/" << scheduler.getCurrentTime() << " ticks busy)\n";
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
     
     // 增加了一列 "Thr" (线程数)
     std::cout << std::left 
@@ -48,6 +105,7 @@ void printSystemStatus(Scheduler& scheduler, const std::map<std::string, int*>&
     for (auto p : procs) {
         std::string memInfo = "None";
         if (memMap.count(p->pid)) memInfo = "Allocated";
+        else if (p->state != FINISHED && mm.getMappedPages(p->pid) > 0) memInfo = "Paged";
         else if (p->state == FINISHED) memInfo = "Freed";
         else if (p->state == SUSPENDED) memInfo = "Swapped";
 
@@ -77,7 +135,9 @@ void printSystemStatus(Scheduler& scheduler, const std::map<std::string, int*>&
 void garbageCollection(Scheduler& scheduler, std::map<std::string, int*>& memMap, MemoryManager& mm) {
     const auto& procs = scheduler.getAllProcesses();
     for (auto p : procs) {
+        if (p->state == FINISHED) mm.releaseAddressSpace(p->pid);
         if (p->state == FINISHED && memMap.count(p->pid)) {
+            mm.untrackHandle(&memMap[p->pid]);
             mm.freeMemory(memMap[p->pid]);
             memMap.erase(p->pid);
             // std::cout << "[GC] Process " << p->pid << " memory freed.\n"; // 嫌吵可以注释掉
@@ -85,6 +145,148 @@ void garbageCollection(Scheduler& scheduler, std::map<std::string, int*>& memMap
     }
 }
 
+// 压测中用真实时间（微秒）代替模拟时钟给消息打时间戳
+int elapsedMicros(std::chrono::steady_clock::time_point begin) {
+    return static_cast<int>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count());
+}
+
+// IPC 吞吐量测试：producers 个线程同时向同一个邮箱发送，主线程接收（MPSC）。
+// 邮箱满时发送者让出 CPU 后重试，统计被背压挡回的次数
+void runIpcBenchmark(int messages, int producers, int capacity) {
+    IPCManager bench;
+    bench.openMailbox("sink", capacity);
+    std::atomic<long long> retries{0};
+    std::vector<std::thread> threads;
+    int perProducer = messages / producers;
+    int total = perProducer * producers;
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&bench, &retries, begin, p, perProducer]() {
+            std::string from = "p" + std::to_string(p);
+            long long local = 0;
+            for (int i = 0; i < perProducer; ++i) {
+                while (bench.sendMessage(from, "sink", "ping", elapsedMicros(begin)) == IpcStatus::WouldBlock) {
+                    local++;
+                    std::this_thread::yield();
+                }
+            }
+            retries += local;
+        });
+    }
+    Message msg;
+    for (int received = 0; received < total;) {
+        if (bench.receiveMessage("sink", msg, elapsedMicros(begin)) == IpcStatus::Ok) received++;
+        else std::this_thread::yield();
+    }
+    for (std::thread& t : threads) t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "\n[IPC Benchmark] " << total << " messages, " << producers << " producer(s) -> 1 consumer, mailbox capacity "
+              << capacity << "\n";
+    std::cout << "  Time: " << seconds * 1000 << " ms | Throughput: " << (seconds > 0 ? total / seconds / 1e6 : 0.0)
+              << " M msg/s | Full-mailbox retries: " << retries.load() << "\n";
+    const Histogram& latency = bench.getLatency("sink");
+    std::cout << "  Queue latency (us): mean " << latency.mean() << ", p50 " << latency.percentile(50) << ", p99 "
+              << latency.percentile(99) << ", max " << latency.max() << "\n";
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+}
+
+// === 批处理模式 ===
+// 脚本在开始前整体解析成紧凑的指令表：高频的 step 直接按操作码执行（连续的 step 合并成一条带次数的指令），
+// 其余命令保留命令名与参数串，执行时才交给原有的命令分派
+enum class OpCode {
+    Step,
+    Exit,
+    Command
+};
+
+struct Instruction {
+    OpCode op;
+    int count;        // Step：连续执行的 tick 数
+    std::string cmd;
+    std::string args; // 命令名之后的部分
+};
+
+// 输出级别：silent 什么都不输出（只看退出码），summary 只在结束时输出指标，full 与交互模式相同（不显示提示符）
+enum class OutputLevel {
+    Silent,
+    Summary,
+    Full
+};
+
+// 空行等价于 step；'#' 开头的行是注释，返回 false
+bool parseInstruction(const std::string& line, Instruction& out) {
+    size_t begin = line.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) {
+        out = {OpCode::Step, 1, "", ""};
+        return true;
+    }
+    if (line[begin] == '#') return false;
+    size_t end = line.find_first_of(" \t\r", begin);
+    out.cmd = line.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+    out.args = end == std::string::npos ? "" : line.substr(end + 1);
+    while (!out.args.empty() && out.args.back() == '\r') out.args.pop_back();
+    out.count = 1;
+    out.op = OpCode::Command;
+    if (out.cmd == "exit") {
+        out.op = OpCode::Exit;
+    } else if (out.cmd == "step") {
+        out.op = OpCode::Step;
+        int n = std::atoi(out.args.c_str());
+        if (n > 1) out.count = n;
+    }
+    return true;
+}
+
+std::vector<Instruction> parseScript(std::istream& in) {
+    std::vector<Instruction> program;
+    std::string line;
+    Instruction ins;
+    while (std::getline(in, line)) {
+        if (!parseInstruction(line, ins)) continue;
+        if (ins.op == OpCode::Step && !program.empty() && program.back().op == OpCode::Step) {
+            program.back().count += ins.count;
+        } else {
+            program.push_back(ins);
+        }
+    }
+    return program;
+}
+
+// 批处理结束时的指标
+void printBatchSummary(const Scheduler& scheduler, const MemoryManager& mm, long long commands, long long unknown,
+                       double seconds) {
+    int finished = 0;
+    long long turnaround = 0, waiting = 0;
+    for (const PCB* p : scheduler.getAllProcesses()) {
+        if (p->state != FINISHED) continue;
+        finished++;
+        turnaround += p->finishTime - p->arrivalTime;
+        waiting += p->finishTime - p->arrivalTime - p->burstTime;
+    }
+    long long accesses = mm.getPageHits() + mm.getPageFaults();
+    int ticks = scheduler.getCurrentTime();
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "\n===== Batch Summary =====\n";
+    std::cout << "Simulated time: " << ticks << " tick(s) | CPU utilization: " << scheduler.getCpuUtilization()
+              << "% | Overhead: " << scheduler.getOverheadTime() << " tick(s)\n";
+    std::cout << "Processes: " << finished << "/" << scheduler.getAllProcesses().size() << " finished | Mean turnaround: "
+              << (finished > 0 ? static_cast<double>(turnaround) / finished : 0.0) << " | Mean waiting: "
+              << (finished > 0 ? static_cast<double>(waiting) / finished : 0.0) << "\n";
+    std::cout << "Paging: " << accesses << " access(es), " << mm.getPageFaults() << " fault(s), hit rate "
+              << (accesses > 0 ? 100.0 * mm.getPageHits() / accesses : 0.0) << "%\n";
+    std::cout << "Commands: " << commands << " (" << unknown << " unknown) | Wall time: " << seconds * 1000 << " ms | "
+              << (seconds > 0 ? commands / seconds : 0.0) << " cmd/s, " << (seconds > 0 ? ticks / seconds : 0.0)
+              << " tick/s\n";
+    std::cout << "=========================\n";
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+}
+
 bool checkSystemStalled(Scheduler& scheduler) {
     // 1. 如果所有进程都跑完了，不算僵死，算正常结束
     if (scheduler.isAllFinished()) return false;
@@ -104,12 +306,54 @@ bool checkSystemStalled(Scheduler& scheduler) {
     return !hasActiveProcess; 
 }
 
+// 磁盘调度算法对比：同一组请求（固定随机种子）依次交给六种算法
+// 16 个进程并发读写，一半请求顺序延续上一次的位置、一半随机跳转；平均每 8ms 到达一个请求
+void runDiskBenchmark(int requests, int blocks) {
+    struct Job {
+        std::string owner;
+        int block;
+        int count;
+        bool write;
+        double arrival;
+    };
+    const int procs = 16;
+    std::mt19937 rng(2024);
+    std::exponential_distribution<double> gap(1.0 / 8.0);
+    std::vector<int> position(procs, 0);
+    for (int& p : position) p = static_cast<int>(rng() % static_cast<unsigned>(blocks));
+
+    std::vector<Job> jobs;
+    double t = 0;
+    for (int i = 0; i < requests; ++i) {
+        int p = static_cast<int>(rng() % procs);
+        int count = 1 + static_cast<int>(rng() % 4);
+        if (rng() % 2 == 0) position[p] = static_cast<int>(rng() % static_cast<unsigned>(blocks));
+        int block = position[p];
+        position[p] = (position[p] + count) % blocks;
+        t += gap(rng);
+        jobs.push_back({"p" + std::to_string(p), block, count, rng() % 4 == 0, t});
+    }
+
+    std::cout << "\n[Disk Benchmark] " << requests << " requests from " << procs << " processes, " << blocks
+              << " blocks (" << (blocks + DiskScheduler::BLOCKS_PER_TRACK - 1) / DiskScheduler::BLOCKS_PER_TRACK << " tracks)\n";
+    std::cout << "Algo    Thru(req/s) Mean(ms)  p95(ms)   p99(ms)   HeadTravel\n";
+    const DiskScheduler::Algorithm algos[] = {
+        DiskScheduler::Algorithm::FCFS, DiskScheduler::Algorithm::SSTF, DiskScheduler::Algorithm::SCAN,
+        DiskScheduler::Algorithm::CSCAN, DiskScheduler::Algorithm::LOOK, DiskScheduler::Algorithm::CLOOK};
+    for (DiskScheduler::Algorithm algo : algos) {
+        DiskScheduler sched(blocks, algo);
+        for (const Job& job : jobs) sched.submit(job.owner, job.block, job.count, job.write, job.arrival);
+        sched.drain();
+        sched.printSummary();
+    }
+}
+
 void printHelp() {
     std::cout << "\n========== OS Simulation Shell ==========\n";
     
     // 1. 系统运行控制
     std::cout << "[ Execution Control ]\n";
-    std::cout << " step (or Enter) : Run 1 tick\n";
+    std::cout << " step [n] (or Enter): Run n tick(s), default 1\n";
     std::cout << " run             : Run until all finished\n";
     std::cout << " switch <1/2>    : Switch Algo (1=FCFS, 2=RR)\n";
     std::cout << " exit            : Exit system\n";
@@ -123,11 +367,21 @@ void printHelp() {
     std::cout << " suspend <pid>   : Suspend process (Swap out)\n";
     std::cout << " active <pid>    : Activate process (Swap in)\n";
     std::cout << " thread <pid>    : Create a thread for process\n";
+    std::cout << " fork <pid> [child]: Clone process (copy-on-write pages)\n";
 
     // 3. 同步与互斥演示模块
     std::cout << "\n[ Sync & Mutex ]\n";
     std::cout << " lock            : Current process tries to acquire lock (P)\n";
     std::cout << " unlock          : Release lock (V)\n";
+    std::cout << " sync_new <sem/mutex/cond/rwlock/barrier> <name> [n]: Create named object (sem value / barrier parties)\n";
+    std::cout << " sem_wait <s> / sem_post <s>: P / V on named semaphore\n";
+    std::cout << " mutex_lock <m> / mutex_unlock <m>: Mutex with priority inheritance\n";
+    std::cout << " cond_wait <c> <m>: Release mutex m and wait on c\n";
+    std::cout << " cond_signal <c> / cond_bcast <c>: Wake one / all waiters of c\n";
+    std::cout << " rdlock <rw> / wrlock <rw> / rwunlock <rw>: Reader-writer lock\n";
+    std::cout << " barrier <b>     : Wait until all parties of barrier arrive\n";
+    std::cout << " prio <pid> <n>  : Set process priority (higher runs first)\n";
+    std::cout << " syncs           : Show sync objects and contention stats\n";
 
     std::cout << "\n[ Banker's Algorithm ]\n";
     std::cout << " res_init <A> <B> <C>: Set system total resources\n";
@@ -137,70 +391,185 @@ void printHelp() {
     // 4. 内存管理模块
     std::cout << "\n[ Memory Simulation ]\n";
     std::cout << " mem <size>      : Allocate contiguous memory (Partition)\n";
+    std::cout << " slab_create <n> <size>   : Create object cache\n";
+    std::cout << " slab_alloc <n> [cpu]     : Allocate object from cache\n";
+    std::cout << " slab_free <n> <addr> [cpu]: Free object back to cache\n";
     std::cout << " access <p> [w]  : Access virtual page <p> (w=write mode)\n";
+    std::cout << " scan <p> <n> [stride]: Access n pages from <p> (sequential scan)\n";
+    std::cout << " readahead <on/off>   : Toggle page prefetch\n";
+    std::cout << " hugepage <n/off>: Enable huge pages of n base pages\n";
+    std::cout << " free <addr>     : Free partition at address\n";
+    std::cout << " compact         : Compact partitions now\n";
+    std::cout << " compact_auto <pct/off>: Auto compact when fragmentation >= pct\n";
     std::cout << " mem_stat        : Show detailed memory status\n";
+    std::cout << " mem_algo <first/next/best/worst/buddy>: Switch partition allocator\n";
 
     // 5. 文件系统模块
     std::cout << "\n[ File System ]\n";
+    std::cout << " (file names may be paths: /a/b, ../x, ./y)\n";
     std::cout << " touch <n> <s>   : Create file (name, size)\n";
-    std::cout << " ls              : List all files\n";
-    std::cout << " rm <name>       : Delete file\n";
-    std::cout << " exec <name>     : Load file & create process\n";
+    std::cout << " mkdir <path>    : Create directory\n";
+    std::cout << " cd [path] / pwd : Change / show current directory\n";
+    std::cout << " ls [path]       : List directory (default: current)\n";
+    std::cout << " rm <name>       : Delete file or empty directory\n";
+    std::cout << " write <n> <text>: Replace file content with text (file grows/shrinks)\n";
+    std::cout << " append <n> <text>: Append text at end of file\n";
+    std::cout << " pwrite <n> <off> <text>: Write text at byte offset\n";
+    std::cout << " pread <n> <off> <len>: Read len bytes at byte offset\n";
+    std::cout << " truncate <n> <s>: Resize file to s bytes\n";
+    std::cout << " cat <name>      : Print file content\n";
+    std::cout << " sync            : Save file system metadata (also on exit, needs --persist in batch mode)\n";
+    std::cout << " snapshot <name> : Copy-on-write snapshot of the file system\n";
+    std::cout << " snapshots       : List snapshots with shared/exclusive blocks\n";
+    std::cout << " rollback <name> : Restore the file system to a snapshot\n";
+    std::cout << " snapdel <name>  : Delete snapshot, freeing blocks only it uses\n";
+    std::cout << " bcache [blocks] : Show (or resize) block buffer cache\n";
+    std::cout << " disksched [fcfs/sstf/scan/cscan/look/clook]: Show (or switch) disk I/O scheduler\n";
+    std::cout << " iobench <n> [blocks]: Compare disk schedulers on n requests (default 16384 blocks)\n";
+    std::cout << " aread <n> <off> <len>: Running process reads file asynchronously (blocks until done)\n";
+    std::cout << " awrite <n> <off> <text>: Running process writes file asynchronously\n";
+    std::cout << " iojob <pid> <arr> <burst> <file> <cpu> [bytes]: Process reading file every <cpu> ticks\n";
+    std::cout << " aiostat         : Show async I/O, disk queue and CPU utilization\n";
+    std::cout << " exec <name> [part]: Create process, demand-page image (part=load whole image)\n";
+    std::cout << " mmap <file> <page>: Map file into current process from page\n";
+    std::cout << " munmap <file>   : Unmap file (write back dirty pages)\n";
 
     // 6. 进程通信模块
     std::cout << "\n[ IPC (Inter-Process Com) ]\n";
-    std::cout << " send <pid> <msg>: Send message to process\n";
-    std::cout << " recv            : Receive message (Current Process)\n";
+    std::cout << " send <pid> <msg>: Send message to process (blocks while its mailbox is full)\n";
+    std::cout << " recv            : Receive message (Current Process, blocks while mailbox is empty)\n";
     std::cout << " ipcs            : Show IPC status\n";
+    std::cout << " mbox <pid> <cap>: Create mailbox with capacity (default " << IPCManager::DEFAULT_CAPACITY << ")\n";
+    std::cout << " ipcbench <n> [producers] [cap]: Message throughput, producers -> 1 consumer\n";
+    std::cout << " mkpipe <name> [cap]: Create byte-stream pipe (default " << Pipe::DEFAULT_CAPACITY << " bytes)\n";
+    std::cout << " pipew <name> <text>: Write to pipe (partial when buffer fills)\n";
+    std::cout << " piper <name> <len>: Read up to len bytes from pipe\n";
+    std::cout << " rmpipe <name>   : Remove pipe\n";
+    std::cout << " sub <topic> [depth]: Subscribe current process to topic\n";
+    std::cout << " unsub <topic>   : Unsubscribe current process\n";
+    std::cout << " pub <topic> <msg>: Publish message to all subscribers\n";
+    std::cout << " fetch <topic>   : Take next message of topic (Current Process)\n";
+    std::cout << " shmget <name> <pages>: Create shared memory segment\n";
+    std::cout << " shmat <name> <page>: Attach segment to current process from page\n";
+    std::cout << " shmdt <name>    : Detach segment from current process\n";
+    std::cout << " shmrm <name>    : Remove segment (freed after the last detach)\n";
+    std::cout << " shmwrite <name> <off> <text>: Write into attached segment\n";
+    std::cout << " shmread <name> <off> <len>: Read from attached segment\n";
 
     std::cout << "=========================================\n";
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    // 命令行参数：--disk <bytes> 指定虚拟磁盘容量（默认 1024 字节）；
+    // --batch <script|-> 非交互地执行脚本（- 表示标准输入），--output silent|summary|full 选择输出级别（默认 summary）；
+    // --persist <name> 从 <name>.meta / <name>.img 载入文件系统并在退出时保存，none 表示不持久化。
+    // 交互模式默认 os_disk，批处理默认不持久化，这样同一脚本每次运行都从空磁盘开始，结果可重现
+    long long diskBytes = 1024;
+    std::string batchScript;
+    std::string persist;
+    bool persistGiven = false;
+    OutputLevel output = OutputLevel::Summary;
+    for (int i = 1; i + 1 < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--disk") diskBytes = std::atoll(argv[++i]);
+        else if (arg == "--batch") batchScript = argv[++i];
+        else if (arg == "--persist") {
+            persist = argv[++i];
+            persistGiven = true;
+        }
+        else if (arg == "--output") {
+            std::string level = argv[++i];
+            output = level == "silent" ? OutputLevel::Silent : level == "full" ? OutputLevel::Full : OutputLevel::Summary;
+        }
+    }
+    if (diskBytes < BLOCK_SIZE) diskBytes = 1024;
+
+    bool batch = !batchScript.empty();
+    if (!persistGiven && !batch) persist = "os_disk";
+    if (persist == "none") persist.clear();
+    std::vector<Instruction> program;
+    if (batch) {
+        std::ifstream file;
+        if (batchScript != "-") {
+            file.open(batchScript);
+            if (!file) {
+                std::cerr << "Cannot open script " << batchScript << "\n";
+                return 1;
+            }
+        }
+        program = parseScript(batchScript == "-" ? std::cin : file);
+    }
+    // 非 full 级别：cout 指向 nullOutput，模块的输出都被丢弃，不占用终端
+    MutedOutput muted(batch && output != OutputLevel::Full);
+
     // 1. 初始化各模块
     Scheduler osScheduler;
     MemoryManager mm(1024, 32, 4);
-    StorageManager disk(1024);
+    StorageManager disk(diskBytes, persist.empty() ? "" : persist + ".img");
+    const std::string diskMetaFile = persist.empty() ? "" : persist + ".meta";
+    if (!diskMetaFile.empty()) disk.loadFromDisk(diskMetaFile); // 上次退出时保存的文件系统元数据
+    AsyncIo aio(osScheduler, disk);
     IPCManager ipc;
     Semaphore globalMutex(1); // 演示同步用
+    SyncTable syncTable(osScheduler);
 
     std::map<std::string, int*> processMemoryMap; 
 
-    printHelp();
-
-    while (true) {
+    // 每条命令之前的例行工作
+    auto housekeeping = [&]() {
         // 自动垃圾回收
         garbageCollection(osScheduler, processMemoryMap, mm);
+        // 内存紧凑的拷贝开销计入模拟时间
+        osScheduler.chargeOverhead(mm.takeCompactionCost(), "memory compaction");
+        // 块缓存按模拟时间周期性写回脏块，已完成的磁盘 I/O 唤醒等待的进程
+        aio.tick();
+    };
 
-        std::cout << "\ncmd> ";
-        std::string line;
-        if (!std::getline(std::cin, line)) break;
+    if (!batch) printHelp();
 
-        // --- 空行默认是 step (方便连按回车演示) ---
-        if (line.empty()) {
-            osScheduler.tick();
-            printSystemStatus(osScheduler, processMemoryMap);
-            continue;
-        }
+    size_t pc = 0;
+    long long commands = 0, unknownCommands = 0;
+    auto begin = std::chrono::steady_clock::now();
+    Instruction input;
+    while (true) {
+        housekeeping();
 
-        std::stringstream ss(line);
-        std::string cmd;
-        ss >> cmd;
+        const Instruction* ins = &input;
+        if (batch) {
+            if (pc >= program.size()) break;
+            ins = &program[pc++];
+        } else {
+            std::cout << "\ncmd> ";
+            std::string line;
+            if (!std::getline(std::cin, line)) break;
+            if (!parseInstruction(line, input)) continue;
+        }
+        commands++;
 
         // ===== 1. 系统控制 =====
-        if (cmd == "exit") {
-            break;
-        }
-        else if (cmd == "help") {
-            printHelp();
-        }
-        else if (cmd == "step") {
-            osScheduler.tick();
-            printSystemStatus(osScheduler, processMemoryMap);
-            if (checkSystemStalled(osScheduler)) {
+        // step 与空行 (方便连按回车演示)：按操作码直接执行，不经过命令解析
+        if (ins->op == OpCode::Step) {
+            for (int i = 0; i < ins->count; ++i) {
+                if (i > 0) housekeeping();
+                osScheduler.tick();
+                aio.tick();
+                printSystemStatus(osScheduler, processMemoryMap, mm);
+            }
+            if (checkSystemStalled(osScheduler) && aio.waiting() > 0) {
+                std::cout << "\n[Info] All processes are waiting for disk I/O.\n";
+            } else if (checkSystemStalled(osScheduler)) {
                 std::cout << "\n[Warning] System Stalled! All processes are BLOCKED/SUSPENDED.\n"
                           << "Hint: Use 'wake <pid>' or 'unlock' to resume execution.\n";
             }
+            continue;
+        }
+        if (ins->op == OpCode::Exit) break;
+
+        const std::string& cmd = ins->cmd;
+        std::stringstream ss(ins->args);
+
+        if (cmd == "help") {
+            printHelp();
         }
         else if (cmd == "run") {
             std::cout << "Running until all finished...\n";
@@ -208,6 +577,12 @@ int main() {
             int ticks = 0;
 
             while (!osScheduler.isAllFinished()) {
+                // 进程都在等 I/O：CPU 空闲，直接快进到下一次 I/O 完成
+                if (checkSystemStalled(osScheduler) && aio.idleUntilCompletion()) {
+                    aio.tick();
+                    ticks++;
+                    continue;
+                }
                 // 先检查是否僵死
                 if (checkSystemStalled(osScheduler)) {
                      std::cout << "\n[System Stop] Deadlock detected! Stopping auto-run.\n";
@@ -215,6 +590,7 @@ int main() {
                 }
 
                 osScheduler.tick();
+                aio.tick();
                 ticks++;
 
                 if (ticks > max_ticks) {
@@ -222,7 +598,7 @@ int main() {
                     break;
                 }
             }
-            printSystemStatus(osScheduler, processMemoryMap);
+            printSystemStatus(osScheduler, processMemoryMap, mm);
         }
         else if (cmd == "switch") {
             int type = 1;
@@ -246,32 +622,32 @@ int main() {
             }
         }
         else if (cmd == "ps") {
-            printSystemStatus(osScheduler, processMemoryMap);
+            printSystemStatus(osScheduler, processMemoryMap, mm);
         }
         else if (cmd == "block") {
             // 手动阻塞当前运行的进程
             osScheduler.blockCurrentProcess();
-            printSystemStatus(osScheduler, processMemoryMap); // 立即刷新显示状态
+            printSystemStatus(osScheduler, processMemoryMap, mm); // 立即刷新显示状态
         }
         else if (cmd == "wake") {
             std::string pid;
             if (ss >> pid) {
                 osScheduler.wakeProcess(osScheduler.getProcess(pid));
-                printSystemStatus(osScheduler, processMemoryMap);
+                printSystemStatus(osScheduler, processMemoryMap, mm);
             }
         }
         else if (cmd == "suspend") {
             std::string pid;
             if (ss >> pid) {
                 osScheduler.suspendProcess(pid);
-                printSystemStatus(osScheduler, processMemoryMap);
+                printSystemStatus(osScheduler, processMemoryMap, mm);
             }
         }
         else if (cmd == "active") {
             std::string pid;
             if (ss >> pid) {
                 osScheduler.activateProcess(pid);
-                printSystemStatus(osScheduler, processMemoryMap);
+                printSystemStatus(osScheduler, processMemoryMap, mm);
             }
         }
         else if (cmd == "thread") {
@@ -280,13 +656,27 @@ int main() {
             osScheduler.createThread(pid);
         }
 
+        else if (cmd == "fork") {
+            std::string pid, child;
+            if (ss >> pid) {
+                if (!(ss >> child)) child = pid + "_f" + std::to_string(osScheduler.getAllProcesses().size());
+                if (osScheduler.forkProcess(pid, child)) {
+                    int shared = mm.forkAddressSpace(pid, child);
+                    std::cout << "[System] Forked " << pid << " -> " << child << " ("
+                              << shared << " page(s) shared copy-on-write)\n";
+                }
+            } else {
+                std::cout << "Usage: fork <pid> [child_pid]\n";
+            }
+        }
+
         // ===== 同步与互斥演示模块 =====
         else if (cmd == "lock") {
             PCB* current = osScheduler.getRunningProcess();
             if (current) {
                 bool success = globalMutex.wait(osScheduler);
                 
-                printSystemStatus(osScheduler, processMemoryMap);
+                printSystemStatus(osScheduler, processMemoryMap, mm);
             } else {
                 std::cout << "[Error] No running process to acquire lock.\n";
             }
@@ -294,7 +684,59 @@ int main() {
         else if (cmd == "unlock") {
             globalMutex.signal(osScheduler);
             
-            printSystemStatus(osScheduler, processMemoryMap);
+            printSystemStatus(osScheduler, processMemoryMap, mm);
+        }
+
+        else if (cmd == "sync_new") {
+            std::string type, name;
+            int value = 1;
+            ss >> type >> name;
+            ss >> value;
+            std::map<std::string, SyncKind> kinds = {{"sem", SyncKind::Semaphore}, {"mutex", SyncKind::Mutex},
+                                                     {"cond", SyncKind::CondVar}, {"rwlock", SyncKind::RWLock},
+                                                     {"barrier", SyncKind::Barrier}};
+            if (name.empty() || !kinds.count(type) || value < 0 || (type == "barrier" && value < 1)) {
+                std::cout << "Usage: sync_new <sem|mutex|cond|rwlock|barrier> <name> [value]\n";
+            } else {
+                syncTable.create(kinds[type], name, value);
+            }
+        }
+        else if (cmd == "sem_wait" || cmd == "sem_post" || cmd == "mutex_lock" || cmd == "mutex_unlock" ||
+                 cmd == "cond_signal" || cmd == "cond_bcast" || cmd == "rdlock" || cmd == "wrlock" ||
+                 cmd == "rwunlock" || cmd == "barrier") {
+            std::string name;
+            if (!(ss >> name)) std::cout << "Usage: " << cmd << " <name>\n";
+            else if (cmd == "sem_wait") syncTable.semWait(name);
+            else if (cmd == "sem_post") syncTable.semPost(name);
+            else if (cmd == "mutex_lock") syncTable.lock(name);
+            else if (cmd == "mutex_unlock") syncTable.unlock(name);
+            else if (cmd == "cond_signal") syncTable.condSignal(name, false);
+            else if (cmd == "cond_bcast") syncTable.condSignal(name, true);
+            else if (cmd == "rdlock") syncTable.readLock(name);
+            else if (cmd == "wrlock") syncTable.writeLock(name);
+            else if (cmd == "rwunlock") syncTable.rwUnlock(name);
+            else syncTable.barrierWait(name);
+        }
+        else if (cmd == "cond_wait") {
+            std::string cond, mutex;
+            if (ss >> cond >> mutex) syncTable.condWait(cond, mutex);
+            else std::cout << "Usage: cond_wait <cond> <mutex>\n";
+        }
+        else if (cmd == "prio") {
+            std::string pid;
+            int priority;
+            PCB* p = nullptr;
+            if (ss >> pid >> priority) p = osScheduler.getProcess(pid);
+            if (p) {
+                syncTable.setPriority(p, priority);
+                std::cout << "[System] Process " << pid << " priority " << p->priority << " (effective "
+                          << p->effectivePriority << ").\n";
+            } else {
+                std::cout << "Usage: prio <pid> <priority>\n";
+            }
+        }
+        else if (cmd == "syncs") {
+            syncTable.printStatus();
         }
 
         // ===== 银行家算法演示模块 =====
@@ -335,79 +777,461 @@ int main() {
             // 顺便打印一下状态
             // mm.printStatus(); 
         }
+        else if (cmd == "free") {
+            int addr;
+            if (ss >> addr) mm.freeMemory(reinterpret_cast<int*>(static_cast<intptr_t>(addr)));
+            else std::cout << "Usage: free <addr>\n";
+        }
+        else if (cmd == "compact") {
+            mm.compact();
+        }
+        else if (cmd == "compact_auto") {
+            std::string arg;
+            ss >> arg;
+            if (arg == "off") {
+                mm.setAutoCompaction(-1);
+                std::cout << "[Memory] Auto compaction disabled\n";
+            } else if (!arg.empty() && std::isdigit(static_cast<unsigned char>(arg[0]))) {
+                mm.setAutoCompaction(std::stoi(arg));
+                std::cout << "[Memory] Auto compaction at fragmentation >= " << arg << "%\n";
+            } else {
+                std::cout << "Usage: compact_auto <pct/off>\n";
+            }
+        }
         else if (cmd == "mem_stat") {
             mm.printStatus();
         }
+        else if (cmd == "mem_algo") {
+            std::string algo;
+            ss >> algo;
+            std::map<std::string, AllocPolicy> policies = {
+                {"first", ALLOC_FIRST_FIT}, {"next", ALLOC_NEXT_FIT},
+                {"best", ALLOC_BEST_FIT},   {"worst", ALLOC_WORST_FIT},
+                {"buddy", ALLOC_BUDDY}
+            };
+            if (policies.count(algo)) {
+                if (mm.setAllocPolicy(policies[algo]))
+                    std::cout << "[Memory] Switched partition allocator to '" << algo << "'\n";
+            } else {
+                std::cout << "Usage: mem_algo <first/next/best/worst/buddy>\n";
+            }
+        }
+        else if (cmd == "slab_create") {
+            std::string name; int size; int perSlab = 8;
+            if (ss >> name >> size) {
+                ss >> perSlab;
+                mm.getSlabAllocator().createCache(name, size, perSlab);
+            } else {
+                std::cout << "Usage: slab_create <name> <obj_size> [objs_per_slab]\n";
+            }
+        }
+        else if (cmd == "slab_alloc") {
+            std::string name; int cpu = 0;
+            SlabAllocator& slab = mm.getSlabAllocator();
+            if (ss >> name) ss >> cpu;
+            if (!name.empty() && cpu >= 0 && cpu < slab.getCpuCount()) {
+                slab.alloc(name, cpu);
+            } else {
+                std::cout << "Usage: slab_alloc <name> [cpu]  (cpu 0-" << slab.getCpuCount() - 1 << ")\n";
+            }
+        }
+        else if (cmd == "slab_free") {
+            std::string name; int addr = -1; int cpu = 0;
+            SlabAllocator& slab = mm.getSlabAllocator();
+            bool ok = static_cast<bool>(ss >> name >> addr);
+            if (ok) ss >> cpu;
+            if (ok && cpu >= 0 && cpu < slab.getCpuCount()) {
+                slab.free(name, addr, cpu);
+            } else {
+                std::cout << "Usage: slab_free <name> <addr> [cpu]  (cpu 0-" << slab.getCpuCount() - 1 << ")\n";
+            }
+        }
         else if (cmd == "access") {
-            // 演示页面置换的核心指令
+            // 演示页面置换的核心指令（有运行中的进程时访问它的地址空间）
             int page;
             std::string mode;
             if (ss >> page) {
                 bool write = false;
                 if (ss >> mode && mode == "w") write = true;
-                mm.accessPage(page, write);
+                PCB* cur = osScheduler.getRunningProcess();
+                mm.accessPage(cur ? cur->pid : MemoryManager::KERNEL_SPACE, page, write);
             } else {
                 std::cout << "Usage: access <page_id> [w]\n";
             }
         }
+        else if (cmd == "scan") {
+            int start, count, stride = 1;
+            if (ss >> start >> count) {
+                ss >> stride;
+                PCB* cur = osScheduler.getRunningProcess();
+                std::string owner = cur ? cur->pid : MemoryManager::KERNEL_SPACE;
+                for (int i = 0; i < count; ++i) mm.accessPage(owner, start + i * stride);
+            } else {
+                std::cout << "Usage: scan <start> <count> [stride]\n";
+            }
+        }
+        else if (cmd == "readahead") {
+            std::string mode;
+            ss >> mode;
+            mm.setReadahead(mode != "off");
+            std::cout << "[Memory] Readahead " << (mode == "off" ? "disabled" : "enabled") << "\n";
+        }
+        else if (cmd == "hugepage") {
+            std::string arg;
+            ss >> arg;
+            if (arg == "off") mm.setHugePages(0);
+            else if (!arg.empty() && std::isdigit(static_cast<unsigned char>(arg[0]))) mm.setHugePages(std::stoi(arg));
+            else std::cout << "Usage: hugepage <pages_per_huge_page/off>\n";
+        }
         
         else if (cmd == "touch") {
             std::string name; int size;
             if (ss >> name >> size) disk.createFile(name, size);
         }
         else if (cmd == "ls") {
-            disk.listFiles();
+            std::string path = ".";
+            ss >> path;
+            disk.listFiles(path);
+        }
+        else if (cmd == "mkdir") {
+            std::string path;
+            if (ss >> path) disk.makeDirectory(path);
+            else std::cout << "Usage: mkdir <path>\n";
+        }
+        else if (cmd == "cd") {
+            std::string path = "/";
+            ss >> path;
+            disk.changeDirectory(path);
+        }
+        else if (cmd == "pwd") {
+            std::cout << disk.getCwd() << "\n";
         }
         else if (cmd == "rm") {
             std::string name; ss >> name;
-            disk.deleteFile(name);
+            if (!name.empty() && mm.isFileMapped(disk.absolutePath(name))) {
+                std::cout << "[Storage] Error: '" << name << "' is mapped into memory, munmap it first.\n";
+            } else {
+                disk.deleteFile(name);
+            }
+        }
+        else if (cmd == "write") {
+            // 行内剩余部分都是内容（可以包含空格）
+            std::string name, content;
+            if (ss >> name) {
+                std::getline(ss >> std::ws, content);
+                disk.writeFile(name, content);
+            } else {
+                std::cout << "Usage: write <name> <content>\n";
+            }
+        }
+        else if (cmd == "append" || cmd == "pwrite") {
+            std::string name, content;
+            int offset = 0;
+            bool ok = static_cast<bool>(ss >> name);
+            if (ok && cmd == "pwrite") ok = static_cast<bool>(ss >> offset);
+            if (ok) {
+                std::getline(ss >> std::ws, content);
+                if (cmd == "append") offset = disk.getFileSize(name);
+                if (cmd == "pwrite" && offset < 0) {
+                    std::cout << "[Storage] Error: Invalid offset " << offset << ".\n";
+                } else if (offset < 0) {
+                    std::cout << "[Storage] Error: File '" << name << "' not found.\n";
+                } else {
+                    int n = disk.pwrite(name, offset, content.data(), static_cast<int>(content.length()));
+                    if (n >= 0) std::cout << "[Storage] Wrote " << n << " bytes to '" << name << "' at offset " << offset << ".\n";
+                }
+            } else {
+                std::cout << "Usage: append <name> <content> | pwrite <name> <offset> <content>\n";
+            }
+        }
+        else if (cmd == "pread") {
+            std::string name;
+            int offset, len;
+            if (ss >> name >> offset >> len && len >= 0) {
+                // 缓冲区不超过文件剩余部分
+                len = std::max(0, std::min(len, disk.getFileSize(name) - std::max(offset, 0)));
+                std::string buf(static_cast<size_t>(len), '\0');
+                int n = disk.pread(name, offset, &buf[0], len);
+                if (n < 0) std::cout << "[Storage] Error: File '" << name << "' not found.\n";
+                else std::cout << printableBytes(buf.substr(0, static_cast<size_t>(n))) << "\n";
+            } else {
+                std::cout << "Usage: pread <name> <offset> <len>\n";
+            }
+        }
+        else if (cmd == "truncate") {
+            std::string name; int size;
+            if (ss >> name >> size) disk.truncate(name, size);
+            else std::cout << "Usage: truncate <name> <size>\n";
+        }
+        else if (cmd == "snapshot" || cmd == "rollback" || cmd == "snapdel") {
+            std::string name;
+            if (!(ss >> name)) std::cout << "Usage: " << cmd << " <name>\n";
+            else if (cmd == "snapshot") disk.createSnapshot(name);
+            else if (cmd == "rollback") disk.rollbackSnapshot(name);
+            else disk.deleteSnapshot(name);
+        }
+        else if (cmd == "snapshots") {
+            disk.listSnapshots();
+        }
+        else if (cmd == "bcache") {
+            int blocks;
+            if (ss >> blocks) disk.setCacheSize(blocks);
+            disk.printCacheStatus();
+        }
+        else if (cmd == "disksched") {
+            std::string algo;
+            if (ss >> algo && !disk.setIoScheduler(algo)) {
+                std::cout << "Usage: disksched [fcfs/sstf/scan/cscan/look/clook]\n";
+            }
+            disk.printIoStatus();
+        }
+        else if (cmd == "iobench") {
+            int requests = 0, blocks = 16384;
+            ss >> requests >> blocks;
+            if (requests > 0 && blocks > 0) runDiskBenchmark(requests, blocks);
+            else std::cout << "Usage: iobench <requests> [blocks]\n";
+        }
+        else if (cmd == "aread" || cmd == "awrite") {
+            std::string name, content;
+            int offset = 0, len = 0;
+            if (cmd == "aread" && ss >> name >> offset >> len) {
+                aio.read(name, offset, len);
+            } else if (cmd == "awrite" && ss >> name >> offset) {
+                std::getline(ss >> std::ws, content);
+                aio.write(name, offset, content);
+            } else {
+                std::cout << "Usage: aread <name> <offset> <len> | awrite <name> <offset> <text>\n";
+            }
+        }
+        else if (cmd == "iojob") {
+            std::string pid, name;
+            int arrival, burst, cpuPerIo, ioBytes = BLOCK_SIZE;
+            if (ss >> pid >> arrival >> burst >> name >> cpuPerIo) {
+                ss >> ioBytes;
+                osScheduler.createProcess(pid, arrival, burst, 0);
+                aio.addJob(pid, name, cpuPerIo, ioBytes);
+            } else {
+                std::cout << "Usage: iojob <pid> <arr> <burst> <file> <cpu_per_io> [io_bytes]\n";
+            }
+        }
+        else if (cmd == "aiostat") {
+            aio.printStatus();
+            disk.printIoStatus();
+        }
+        else if (cmd == "sync") {
+            if (diskMetaFile.empty()) std::cout << "[Storage] Persistence is off (start with --persist <name>).\n";
+            else disk.saveToDisk(diskMetaFile);
+        }
+        else if (cmd == "cat") {
+            std::string name;
+            if (ss >> name) {
+                if (disk.getFileSize(name) < 0) std::cout << "[Storage] Error: File '" << name << "' not found.\n";
+                else std::cout << printableBytes(disk.readFile(name)) << "\n";
+            }
         }
         else if (cmd == "exec") {
             // 模拟从磁盘加载文件并创建进程
-            std::string name;
+            std::string name, mode;
             if (ss >> name) {
+                ss >> mode;
                 int size = disk.getFileSize(name);
-                if (size > 0) {
+                std::string pid = name + "_proc";
+                if (size <= 0) {
+                    std::cout << "[Error] File not found.\n";
+                } else if (osScheduler.getProcess(pid)) {
+                    std::cout << "[Error] Process " << pid << " already exists.\n";
+                } else if (mode != "part") {
+                    // 按需调页：只把程序文件映射到进程的第 0 页起，缺页时再从磁盘读入；
+                    // 映射成功后才创建进程，失败时丢弃为它建立的地址空间
+                    if (mm.mapFile(pid, 0, disk, name) > 0) {
+                        osScheduler.createProcess(pid, osScheduler.getCurrentTime(), size, size);
+                        std::cout << "[Loader] Mapped " << name << " as process " << pid << " (demand paging)\n";
+                    } else {
+                        mm.releaseAddressSpace(pid);
+                    }
+                } else {
                     int* mem = mm.allocateMemory(size);
                     if (mem) {
-                        std::string pid = name + "_proc";
                         osScheduler.createProcess(pid, osScheduler.getCurrentTime(), size, size);
                         processMemoryMap[pid] = mem;
+                        mm.trackHandle(&processMemoryMap[pid]);
                         std::cout << "[Loader] Loaded " << name << " into memory as process " << pid << "\n";
                     } else {
                         std::cout << "[Error] Not enough memory.\n";
+                        if (mm.getFreeTotal() >= size)
+                            std::cout << "Hint: " << mm.getFreeTotal() << " units free but fragmented, try 'compact'.\n";
                     }
-                } else {
-                    std::cout << "[Error] File not found.\n";
                 }
             }
         }
+        else if (cmd == "mmap") {
+            std::string name; int page;
+            if (ss >> name >> page) {
+                PCB* cur = osScheduler.getRunningProcess();
+                mm.mapFile(cur ? cur->pid : MemoryManager::KERNEL_SPACE, page, disk, name);
+            } else {
+                std::cout << "Usage: mmap <file> <start_page>\n";
+            }
+        }
+        else if (cmd == "munmap") {
+            std::string name;
+            if (ss >> name) {
+                PCB* cur = osScheduler.getRunningProcess();
+                mm.unmapFile(cur ? cur->pid : MemoryManager::KERNEL_SPACE, name);
+            } else {
+                std::cout << "Usage: munmap <file>\n";
+            }
+        }
 
         // ===== 4. IPC (保留) =====
         else if (cmd == "send") {
             std::string target, msg;
-            ss >> target >> msg;
-            PCB* cur = osScheduler.getRunningProcess();
-            if (cur) ipc.sendMessage(cur->pid, target, msg);
-            else std::cout << "[Error] No running process to send message.\n";
+            ss >> target;
+            std::getline(ss >> std::ws, msg);
+            IpcStatus status = ipc.send(osScheduler, target, msg);
+            if (status == IpcStatus::NoProcess) std::cout << "[Error] No running process to send message.\n";
+            else if (status == IpcStatus::TooLong) std::cout << "[IPC] Error: Message longer than " << Message::MAX_CONTENT << " bytes.\n";
         }
         else if (cmd == "recv") {
-            PCB* cur = osScheduler.getRunningProcess();
             Message m;
-            if (cur && ipc.receiveMessage(cur->pid, m)) {
-                std::cout << "[IPC] Recv from " << m.senderPid << ": " << m.content << "\n";
+            IpcStatus status = ipc.receive(osScheduler, m);
+            if (status == IpcStatus::Ok) std::cout << "[IPC] Recv from " << m.sender() << ": " << m.text() << "\n";
+            else if (status == IpcStatus::NoProcess) std::cout << "[IPC] No running process to receive.\n";
+        }
+        else if (cmd == "ipcs") {
+            ipc.printStatus(osScheduler.getCurrentTime());
+            mm.printSegments();
+        }
+        else if (cmd == "mbox") {
+            std::string pid;
+            int capacity = 0;
+            if (ss >> pid >> capacity && ipc.openMailbox(pid, capacity)) ipc.printStatus();
+            else std::cout << "Usage: mbox <pid> <capacity>\n";
+        }
+        else if (cmd == "ipcbench") {
+            int messages = 0, producers = 1, capacity = 1024;
+            ss >> messages >> producers >> capacity;
+            if (messages > 0 && producers > 0 && capacity > 0 && messages >= producers) runIpcBenchmark(messages, producers, capacity);
+            else std::cout << "Usage: ipcbench <messages> [producers] [capacity]\n";
+        }
+        else if (cmd == "mkpipe") {
+            std::string name; int capacity = Pipe::DEFAULT_CAPACITY;
+            if (ss >> name) {
+                ss >> capacity;
+                if (ipc.createPipe(name, capacity, osScheduler.getCurrentTime())) std::cout << "[IPC] Pipe '" << name << "' created (" << capacity << " bytes).\n";
+                else std::cout << "[IPC] Error: Pipe '" << name << "' already exists or capacity invalid.\n";
             } else {
-                std::cout << "[IPC] No messages.\n";
+                std::cout << "Usage: mkpipe <name> [capacity]\n";
             }
         }
-        else if (cmd == "ipcs") {
-            ipc.printStatus();
+        else if (cmd == "pipew") {
+            std::string name, text;
+            if (ss >> name) {
+                std::getline(ss >> std::ws, text);
+                int n = ipc.writePipe(name, text, osScheduler.getCurrentTime());
+                if (n < 0) std::cout << "[IPC] Error: Pipe '" << name << "' not found.\n";
+                else if (text.empty()) std::cout << "[IPC] Nothing to write.\n";
+                else if (n < static_cast<int>(text.size())) std::cout << "[IPC] Pipe '" << name << "' full: wrote " << n << " of " << text.size() << " byte(s).\n";
+                else std::cout << "[IPC] Wrote " << n << " byte(s) to pipe '" << name << "'.\n";
+            } else {
+                std::cout << "Usage: pipew <name> <text>\n";
+            }
+        }
+        else if (cmd == "piper") {
+            std::string name, data; int len;
+            if (ss >> name >> len && len >= 0) {
+                int n = ipc.readPipe(name, len, data, osScheduler.getCurrentTime());
+                if (n < 0) std::cout << "[IPC] Error: Pipe '" << name << "' not found.\n";
+                else if (n == 0) std::cout << "[IPC] Pipe '" << name << "' is empty.\n";
+                else std::cout << "[IPC] Read " << n << " byte(s) from pipe '" << name << "': " << data << "\n";
+            } else {
+                std::cout << "Usage: piper <name> <len>\n";
+            }
+        }
+        else if (cmd == "rmpipe") {
+            std::string name;
+            if (ss >> name && ipc.removePipe(name)) std::cout << "[IPC] Pipe '" << name << "' removed.\n";
+            else std::cout << "[IPC] Error: Pipe not found.\n";
+        }
+        else if (cmd == "sub" || cmd == "unsub" || cmd == "pub" || cmd == "fetch") {
+            std::string topic;
+            PCB* cur = osScheduler.getRunningProcess();
+            int now = osScheduler.getCurrentTime();
+            if (!(ss >> topic)) {
+                std::cout << "Usage: " << cmd << " <topic>" << (cmd == "pub" ? " <msg>" : cmd == "sub" ? " [depth]" : "") << "\n";
+            } else if (!cur) {
+                std::cout << "[Error] No running process.\n";
+            } else if (cmd == "sub") {
+                int depth = Topic::DEFAULT_DEPTH;
+                ss >> depth;
+                ipc.subscribe(topic, cur->pid, std::max(depth, 1), now);
+                std::cout << "[IPC] " << cur->pid << " subscribed to '" << topic << "'.\n";
+            } else if (cmd == "unsub") {
+                if (ipc.unsubscribe(topic, cur->pid)) std::cout << "[IPC] " << cur->pid << " unsubscribed from '" << topic << "'.\n";
+                else std::cout << "[IPC] Error: " << cur->pid << " is not subscribed to '" << topic << "'.\n";
+            } else if (cmd == "pub") {
+                std::string msg;
+                std::getline(ss >> std::ws, msg);
+                int fanout = ipc.publish(topic, cur->pid, msg, now);
+                if (fanout < 0) std::cout << "[IPC] Error: Topic '" << topic << "' has no subscribers.\n";
+                else std::cout << "[IPC] Published to '" << topic << "', delivered to " << fanout << " subscriber(s).\n";
+            } else {
+                Topic::Payload msg;
+                IpcStatus status = ipc.fetch(topic, cur->pid, msg, now);
+                if (status == IpcStatus::Ok) std::cout << "[IPC] " << cur->pid << " got from '" << topic << "' (" << msg->sender << "): " << msg->data << "\n";
+                else if (status == IpcStatus::WouldBlock) std::cout << "[IPC] No new messages on '" << topic << "'.\n";
+                else std::cout << "[IPC] Error: " << cur->pid << " is not subscribed to '" << topic << "'.\n";
+            }
+        }
+        else if (cmd == "shmget") {
+            std::string name; int pages;
+            if (ss >> name >> pages) mm.createSegment(name, pages);
+            else std::cout << "Usage: shmget <name> <pages>\n";
+        }
+        else if (cmd == "shmat" || cmd == "shmdt" || cmd == "shmrm") {
+            std::string name; int page = 0;
+            PCB* cur = osScheduler.getRunningProcess();
+            std::string owner = cur ? cur->pid : MemoryManager::KERNEL_SPACE;
+            if (!(ss >> name) || (cmd == "shmat" && !(ss >> page))) std::cout << "Usage: " << cmd << " <name>" << (cmd == "shmat" ? " <start_page>" : "") << "\n";
+            else if (cmd == "shmat") mm.attachSegment(owner, name, page);
+            else if (cmd == "shmdt") mm.detachSegment(owner, name);
+            else mm.removeSegment(name);
+        }
+        else if (cmd == "shmwrite") {
+            std::string name, text; int offset;
+            if (ss >> name >> offset) {
+                std::getline(ss >> std::ws, text);
+                PCB* cur = osScheduler.getRunningProcess();
+                int n = mm.writeSegment(cur ? cur->pid : MemoryManager::KERNEL_SPACE, name, offset, text);
+                if (n >= 0) std::cout << "[SHM] Wrote " << n << " byte(s) to '" << name << "' at offset " << offset << ".\n";
+            } else {
+                std::cout << "Usage: shmwrite <name> <offset> <text>\n";
+            }
+        }
+        else if (cmd == "shmread") {
+            std::string name; int offset, len;
+            if (ss >> name >> offset >> len) {
+                PCB* cur = osScheduler.getRunningProcess();
+                std::string data;
+                int n = mm.readSegment(cur ? cur->pid : MemoryManager::KERNEL_SPACE, name, offset, len, data);
+                if (n >= 0) std::cout << "[SHM] Read " << n << " byte(s): " << data.c_str() << "\n";
+            } else {
+                std::cout << "Usage: shmread <name> <offset> <len>\n";
+            }
         }
 
         else {
+            unknownCommands++;
             std::cout << "Unknown command. Type 'help'.\n";
         }
     }
 
+    if (!diskMetaFile.empty()) disk.saveToDisk(diskMetaFile);
+    if (batch) {
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        muted.restore();
+        if (output != OutputLevel::Silent) printBatchSummary(osScheduler, mm, commands, unknownCommands, seconds);
+        return unknownCommands > 0 ? 1 : 0;
+    }
     return 0;
-}
\ No newline at end of file
+}
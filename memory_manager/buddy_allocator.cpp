@@ -0,0 +1,97 @@
+#include "buddy_allocator.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+BuddyAllocator::BuddyAllocator(int base, int totalSize, int minBlock)
+    : base(base),
+      minBlock(minBlock > 0 ? minBlock : 1),
+      maxOrder(0) {
+    // 找到不超过 totalSize 的最大 minBlock * 2^k
+    while (sizeOfOrder(maxOrder + 1) <= totalSize) ++maxOrder;
+    capacity = totalSize >= this->minBlock ? sizeOfOrder(maxOrder) : 0;
+    freeSize = capacity;
+
+    freeLists.resize(static_cast<size_t>(maxOrder) + 1);
+    if (capacity > 0) freeLists[maxOrder].insert(0);
+}
+
+int BuddyAllocator::orderFor(int size) const {
+    int order = 0;
+    while (order <= maxOrder && sizeOfOrder(order) < size) ++order;
+    return order;
+}
+
+int BuddyAllocator::allocate(int size) {
+    if (size <= 0 || capacity == 0) return -1;
+
+    int order = orderFor(size);
+    if (order > maxOrder) return -1;
+
+    // 1. 从目标阶向上找第一个非空的空闲链
+    int cur = order;
+    while (cur <= maxOrder && freeLists[cur].empty()) ++cur;
+    if (cur > maxOrder) return -1;
+
+    int offset = *freeLists[cur].begin();
+    freeLists[cur].erase(freeLists[cur].begin());
+
+    // 2. 逐级对半分裂，右半块挂回低一阶的空闲链
+    while (cur > order) {
+        --cur;
+        freeLists[cur].insert(offset + sizeOfOrder(cur));
+    }
+
+    allocated.emplace(offset, AllocInfo{order, size});
+    freeSize -= sizeOfOrder(order);
+    requestedSize += size;
+    return base + offset;
+}
+
+bool BuddyAllocator::free(int addr) {
+    int offset = addr - base;
+    auto it = allocated.find(offset);
+    if (it == allocated.end()) return false;
+
+    int order = it->second.order;
+    freeSize += sizeOfOrder(order);
+    requestedSize -= it->second.requested;
+    allocated.erase(it);
+
+    // 伙伴地址 = 偏移 XOR 块大小；伙伴空闲就合并并继续向上
+    while (order < maxOrder) {
+        int buddy = offset ^ sizeOfOrder(order);
+        auto bit = freeLists[order].find(buddy);
+        if (bit == freeLists[order].end()) break;
+        freeLists[order].erase(bit);
+        offset = std::min(offset, buddy);
+        ++order;
+    }
+    freeLists[order].insert(offset);
+    return true;
+}
+
+int BuddyAllocator::blockSizeOf(int addr) const {
+    auto it = allocated.find(addr - base);
+    return it == allocated.end() ? 0 : sizeOfOrder(it->second.order);
+}
+
+int BuddyAllocator::getLargestFree() const {
+    for (int order = maxOrder; order >= 0; --order) {
+        if (!freeLists[order].empty()) return sizeOfOrder(order);
+    }
+    return 0;
+}
+
+void BuddyAllocator::printStatus() const {
+    std::cout << "  Buddy Free Lists (Capacity: " << capacity << "):\n";
+    bool any = false;
+    for (int order = maxOrder; order >= 0; --order) {
+        if (freeLists[order].empty()) continue;
+        any = true;
+        std::cout << "    | Size " << std::setw(5) << sizeOfOrder(order) << " | ";
+        for (int off : freeLists[order]) std::cout << (base + off) << " ";
+        std::cout << "\n";
+    }
+    if (!any) std::cout << "    (None)\n";
+}
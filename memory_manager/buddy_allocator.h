@@ -0,0 +1,56 @@
+// memory_manager/buddy_allocator.h
+#ifndef BUDDY_ALLOCATOR_H
+#define BUDDY_ALLOCATOR_H
+
+#include <vector>
+#include <set>
+#include <unordered_map>
+
+// 伙伴系统 (Buddy System) 分配器
+// 所有块大小都是 minBlock * 2^k，分配时逐级对半分裂，释放时与伙伴逐级合并，
+// 分裂和合并都只走 O(log N) 级。
+class BuddyAllocator {
+public:
+    // base: 管理区的起始地址；totalSize 向下取整为 minBlock * 2^k
+    BuddyAllocator(int base, int totalSize, int minBlock = 1);
+
+    // 返回分配到的起始地址，失败返回 -1
+    int allocate(int size);
+    // 释放 addr 处的块，地址无效返回 false
+    bool free(int addr);
+
+    bool owns(int addr) const { return allocated.count(addr - base) != 0U; }
+    int blockSizeOf(int addr) const;
+
+    // 统计信息
+    int getCapacity() const { return capacity; }
+    int getFreeSize() const { return freeSize; }
+    int getAllocatedBlockSize() const { return capacity - freeSize; }
+    int getRequestedSize() const { return requestedSize; }
+    int getInternalWaste() const { return getAllocatedBlockSize() - requestedSize; }
+    int getLargestFree() const;
+    bool empty() const { return allocated.empty(); }
+
+    void printStatus() const;
+
+private:
+    struct AllocInfo {
+        int order;
+        int requested;
+    };
+
+    int orderFor(int size) const;
+    int sizeOfOrder(int order) const { return minBlock << order; }
+
+    int base;
+    int minBlock;
+    int maxOrder;
+    int capacity;
+    int freeSize;
+    int requestedSize = 0;
+
+    std::vector<std::set<int>> freeLists;           // 每一阶的空闲块（相对 base 的偏移）
+    std::unordered_map<int, AllocInfo> allocated;   // 偏移 -> 阶数 + 实际申请大小
+};
+
+#endif
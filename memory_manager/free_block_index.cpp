@@ -0,0 +1,102 @@
+#include "free_block_index.h"
+#include <algorithm>
+
+FreeBlockIndex::FreeBlockIndex(int base, int totalSize)
+    : base(base),
+      totalSize(totalSize) {
+    while (leaves < totalSize) leaves <<= 1;
+    maxTree.assign(static_cast<size_t>(leaves) * 2, 0);
+    if (totalSize > 0) add(base, totalSize);
+}
+
+/* ================= 线段树维护 ================= */
+
+void FreeBlockIndex::setLeaf(int addr, int value) {
+    int node = leaves + (addr - base);
+    maxTree[node] = value;
+    for (node >>= 1; node >= 1; node >>= 1) {
+        maxTree[node] = std::max(maxTree[2 * node], maxTree[2 * node + 1]);
+    }
+}
+
+// 在 [lo, hi) 内找下标 >= from 且值 >= size 的最左叶子
+int FreeBlockIndex::descend(int node, int lo, int hi, int from, int size) const {
+    if (hi <= from || maxTree[node] < size) return -1;
+    if (hi - lo == 1) return lo;
+    int mid = (lo + hi) / 2;
+    int res = descend(2 * node, lo, mid, from, size);
+    if (res >= 0) return res;
+    return descend(2 * node + 1, mid, hi, from, size);
+}
+
+/* ================= 索引增删 ================= */
+
+void FreeBlockIndex::add(int start, int size) {
+    byAddr.emplace(start, size);
+    bySize.emplace(size, start);
+    setLeaf(start, size);
+    freeTotal += size;
+}
+
+void FreeBlockIndex::remove(std::map<int, int>::iterator it) {
+    bySize.erase({it->second, it->first});
+    setLeaf(it->first, 0);
+    freeTotal -= it->second;
+    byAddr.erase(it);
+}
+
+/* ================= 放置策略 ================= */
+
+int FreeBlockIndex::findFirstFit(int size, int from) const {
+    if (size <= 0 || maxTree[1] < size) return -1;
+    int leaf = descend(1, 0, leaves, std::max(from - base, 0), size);
+    return leaf < 0 ? -1 : base + leaf;
+}
+
+int FreeBlockIndex::findBestFit(int size) const {
+    auto it = bySize.lower_bound({size, base - 1});
+    return it == bySize.end() ? -1 : it->second;
+}
+
+int FreeBlockIndex::findWorstFit(int size) const {
+    if (bySize.empty() || bySize.rbegin()->first < size) return -1;
+    return bySize.rbegin()->second;
+}
+
+/* ================= 切分与合并 ================= */
+
+void FreeBlockIndex::carve(int start, int size) {
+    auto it = byAddr.find(start);
+    if (it == byAddr.end() || it->second < size) return;
+
+    int remain = it->second - size;
+    remove(it);
+    if (remain > 0) add(start + size, remain);
+}
+
+void FreeBlockIndex::release(int start, int size) {
+    // 右邻居：起始地址恰好等于本块末尾
+    auto next = byAddr.find(start + size);
+    if (next != byAddr.end()) {
+        size += next->second;
+        remove(next);
+    }
+    // 左邻居：地址小于 start 的最后一个块，且末尾恰好接上
+    auto prev = byAddr.lower_bound(start);
+    if (prev != byAddr.begin()) {
+        --prev;
+        if (prev->first + prev->second == start) {
+            start = prev->first;
+            size += prev->second;
+            remove(prev);
+        }
+    }
+    add(start, size);
+}
+
+void FreeBlockIndex::reset(const std::vector<std::pair<int, int>>& blocks) {
+    while (!byAddr.empty()) remove(byAddr.begin());
+    for (const auto& b : blocks) {
+        if (b.second > 0) release(b.first, b.second);
+    }
+}
@@ -0,0 +1,54 @@
+// memory_manager/free_block_index.h
+#ifndef FREE_BLOCK_INDEX_H
+#define FREE_BLOCK_INDEX_H
+
+#include <map>
+#include <set>
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+// 空闲分区索引：同时按地址和按大小组织空闲块
+//  - byAddr : 起始地址 -> 大小，释放时 O(log n) 找到左右邻居合并
+//  - bySize : (大小, 起始地址)，最佳/最坏适应 O(log n)
+//  - maxTree: 以地址为下标的最大值线段树，首次/循环首次适应 O(log N)
+class FreeBlockIndex {
+public:
+    FreeBlockIndex(int base, int totalSize);
+
+    // 各放置策略的查找，返回空闲块起始地址，找不到返回 -1
+    int findFirstFit(int size, int from) const;
+    int findBestFit(int size) const;
+    int findWorstFit(int size) const;
+
+    // 从起始于 start 的空闲块头部切走 size 个单元
+    void carve(int start, int size);
+    // 归还 [start, start+size)，并与相邻空闲块合并
+    void release(int start, int size);
+    // 清空后重新设定为若干空闲块（紧凑时批量重建）
+    void reset(const std::vector<std::pair<int, int>>& blocks);
+
+    int getBase() const { return base; }
+    int getLimit() const { return base + totalSize; }
+    int getFreeTotal() const { return freeTotal; }
+    int getLargest() const { return bySize.empty() ? 0 : bySize.rbegin()->first; }
+    std::size_t count() const { return byAddr.size(); }
+    const std::map<int, int>& blocks() const { return byAddr; }
+
+private:
+    void add(int start, int size);
+    void remove(std::map<int, int>::iterator it);
+    void setLeaf(int addr, int value);
+    int descend(int node, int lo, int hi, int from, int size) const;
+
+    int base;
+    int totalSize;
+    int freeTotal = 0;
+    int leaves = 1;
+
+    std::map<int, int> byAddr;
+    std::set<std::pair<int, int>> bySize;
+    std::vector<int> maxTree;
+};
+
+#endif
@@ -1,140 +1,1112 @@
 #include "memory_manager.h"
+#include "../storage/storage.h"
 #include <iostream>
 #include <algorithm>
+#include <cstring>
+#include <climits>
 
 /* ================= 构造函数 ================= */
 
-MemoryManager::MemoryManager(int totalSize, int pageSize, int maxFrames)
+MemoryManager::MemoryManager(int totalSize, int pageSize, int maxFrames, const std::string& swapPath)
     : totalSize(totalSize),
       pageSize(pageSize),
-      maxFrames(maxFrames) {
-    freeList.push_back({1, totalSize}); // 起始地址设为1，避免 nullptr
-    for (int i = 0; i < 10; ++i) fileArea.insert(i);
+      maxFrames(maxFrames),
+      freeIndex(1, totalSize), // 起始地址设为1，避免 nullptr
+      buddy(1, totalSize),
+      slabAllocator(*this),
+      swapDevice(swapPath, pageSize) {
+    physicalMemory.assign(static_cast<size_t>(maxFrames) * pageSize, 0);
 }
 
 /* ================= 连续分区管理 ================= */
 
+static const char* policyName(AllocPolicy policy) {
+    switch (policy) {
+        case ALLOC_NEXT_FIT:  return "Next Fit";
+        case ALLOC_BEST_FIT:  return "Best Fit";
+        case ALLOC_WORST_FIT: return "Worst Fit";
+        case ALLOC_BUDDY:     return "Buddy";
+        default:              return "First Fit";
+    }
+}
+
+bool MemoryManager::setAllocPolicy(AllocPolicy policy) {
+    if (policy == allocPolicy) return true;
+    bool engineChange = (policy == ALLOC_BUDDY) || (allocPolicy == ALLOC_BUDDY);
+    if (engineChange && !usedBlocks.empty()) {
+        std::cout << "[Memory] Error: Free all partitions before switching allocator.\n";
+        return false;
+    }
+    allocPolicy = policy;
+    return true;
+}
+
 int* MemoryManager::allocateMemory(int size) {
-    for (auto it = freeList.begin(); it != freeList.end(); ++it) {
-        if (it->size >= size) {
-            int addr = it->start;
-            usedBlocks.emplace(addr, Block{addr, size});
-
-            if (it->size == size) {
-                freeList.erase(it);
-            } else {
-                it->start += size;
-                it->size -= size;
-            }
+    if (size <= 0) return nullptr;
 
-            std::cout << "Allocate memory at " << addr
-                      << ", size=" << size << std::endl;
+    if (allocPolicy == ALLOC_BUDDY) {
+        int addr = buddy.allocate(size);
+        if (addr < 0) return nullptr;
+        usedBlocks.emplace(addr, Block{addr, size, false});
+
+        std::cout << "Allocate memory at " << addr
+                  << ", size=" << size
+                  << " (buddy block=" << buddy.blockSizeOf(addr) << ")" << std::endl;
+        return reinterpret_cast<int*>(static_cast<intptr_t>(addr));
+    }
 
-            // 使用 intptr_t 作为安全中转
-            return reinterpret_cast<int*>(static_cast<intptr_t>(addr));
+    int addr = findFreeBlock(size);
+    if (addr < 0 && autoCompactThreshold >= 0 && freeIndex.getFreeTotal() >= size &&
+        getExternalFragmentation() >= autoCompactThreshold) {
+        // 空闲总量够但没有足够大的连续块：碎片超过阈值时先紧凑再重试
+        std::cout << "[Compact] Auto compaction triggered for request of " << size << ".\n";
+        compact();
+        addr = findFreeBlock(size);
+    }
+    if (addr < 0) return nullptr;
+
+    freeIndex.carve(addr, size);
+    usedBlocks.emplace(addr, Block{addr, size, false});
+    nextFitCursor = addr + size;
+
+    std::cout << "Allocate memory at " << addr
+              << ", size=" << size << std::endl;
+
+    // 使用 intptr_t 作为安全中转
+    return reinterpret_cast<int*>(static_cast<intptr_t>(addr));
+}
+
+int MemoryManager::findFreeBlock(int size) const {
+    switch (allocPolicy) {
+        case ALLOC_BEST_FIT:  return freeIndex.findBestFit(size);
+        case ALLOC_WORST_FIT: return freeIndex.findWorstFit(size);
+        case ALLOC_NEXT_FIT: {
+            // 从上次分配的位置向后找，找不到再从头绕回
+            int addr = freeIndex.findFirstFit(size, nextFitCursor);
+            return addr >= 0 ? addr : freeIndex.findFirstFit(size, freeIndex.getBase());
         }
+        default:              return freeIndex.findFirstFit(size, freeIndex.getBase());
     }
-    return nullptr;
 }
 
-void MemoryManager::freeMemory(int* ptr) {
-    if (ptr == nullptr) return;
+bool MemoryManager::freeMemory(int* ptr) {
+    if (ptr == nullptr) return false;
 
     int addr = static_cast<int>(reinterpret_cast<intptr_t>(ptr));
 
     auto it = usedBlocks.find(addr);
-    if (it == usedBlocks.end()) return;
+    if (it == usedBlocks.end()) return false;
+    if (it->second.pinned) {
+        std::cout << "[Memory] Error: Partition at " << addr << " is pinned (in use by a slab cache).\n";
+        return false;
+    }
+    for (int** handle : handles) {
+        if (*handle == ptr) {
+            std::cout << "[Memory] Error: Partition at " << addr << " is still owned by a process.\n";
+            return false;
+        }
+    }
+
+    if (allocPolicy == ALLOC_BUDDY) {
+        buddy.free(addr);
+        usedBlocks.erase(it);
+        std::cout << "Free memory at " << addr << std::endl;
+        return true;
+    }
 
-    freeList.push_back(it->second);
+    freeIndex.release(it->second.start, it->second.size);
     usedBlocks.erase(it);
 
-    std::sort(freeList.begin(), freeList.end(),
-              [](const Block& a, const Block& b) {
-                  return a.start < b.start;
-              });
+    std::cout << "Free memory at " << addr << std::endl;
+    return true;
+}
 
-    for (size_t i = 0; i + 1 < freeList.size();) {
-        if (freeList[i].start + freeList[i].size == freeList[i + 1].start) {
-            freeList[i].size += freeList[i + 1].size;
-            freeList.erase(freeList.begin() + static_cast<long>(i + 1));
-        } else {
-            ++i;
+/* ================= 分区紧凑 ================= */
+
+void MemoryManager::pinMemory(int* ptr) {
+    int addr = static_cast<int>(reinterpret_cast<intptr_t>(ptr));
+    auto it = usedBlocks.find(addr);
+    if (it != usedBlocks.end()) it->second.pinned = true;
+}
+
+void MemoryManager::trackHandle(int** handle) {
+    if (handle) handles.push_back(handle);
+}
+
+void MemoryManager::untrackHandle(int** handle) {
+    handles.erase(std::remove(handles.begin(), handles.end(), handle), handles.end());
+}
+
+CompactionResult MemoryManager::compact() {
+    CompactionResult result;
+    result.fragBefore = getExternalFragmentation();
+    result.fragAfter = result.fragBefore;
+
+    if (allocPolicy == ALLOC_BUDDY) {
+        std::cout << "[Compact] Buddy allocator does not support compaction.\n";
+        return result;
+    }
+
+    // 1. 按地址顺序排列已用分区
+    std::vector<Block> blocks;
+    blocks.reserve(usedBlocks.size());
+    for (const auto& pair : usedBlocks) blocks.push_back(pair.second);
+    std::sort(blocks.begin(), blocks.end(),
+              [](const Block& a, const Block& b) { return a.start < b.start; });
+
+    // 2. 逐个向低地址滑动；固定分区原地不动，游标跳过它
+    std::unordered_map<int, int> relocation; // 旧地址 -> 新地址
+    std::vector<std::pair<int, int>> gaps;
+    int cursor = freeIndex.getBase();
+    for (Block& b : blocks) {
+        if (b.pinned) {
+            gaps.emplace_back(cursor, b.start - cursor);
+        } else if (b.start != cursor) {
+            relocation[b.start] = cursor;
+            result.movedBlocks++;
+            result.movedUnits += b.size;
+            b.start = cursor;
         }
+        cursor = b.start + b.size;
     }
+    gaps.emplace_back(cursor, freeIndex.getLimit() - cursor);
 
-    std::cout << "Free memory at " << addr << std::endl;
+    // 3. 重建已用表与空闲索引
+    usedBlocks.clear();
+    for (const Block& b : blocks) usedBlocks.emplace(b.start, b);
+    freeIndex.reset(gaps);
+    nextFitCursor = freeIndex.getBase();
+
+    // 4. 改写所有登记过的句柄
+    for (int** handle : handles) {
+        int addr = static_cast<int>(reinterpret_cast<intptr_t>(*handle));
+        auto it = relocation.find(addr);
+        if (it != relocation.end()) {
+            *handle = reinterpret_cast<int*>(static_cast<intptr_t>(it->second));
+        }
+    }
+
+    // 5. 拷贝开销计入模拟时间
+    result.costTicks = (result.movedUnits + COPY_UNITS_PER_TICK - 1) / COPY_UNITS_PER_TICK;
+    result.fragAfter = getExternalFragmentation();
+    pendingCompactionTicks += result.costTicks;
+    compactions++;
+    totalCompactedUnits += result.movedUnits;
+    totalCompactionTicks += result.costTicks;
+
+    std::cout << "[Compact] Moved " << result.movedBlocks << " block(s), "
+              << result.movedUnits << " units, cost " << result.costTicks << " tick(s). "
+              << std::fixed << std::setprecision(1)
+              << "External fragmentation " << result.fragBefore << "% -> " << result.fragAfter << "%\n";
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+    return result;
+}
+
+int MemoryManager::takeCompactionCost() {
+    int ticks = pendingCompactionTicks;
+    pendingCompactionTicks = 0;
+    return ticks;
+}
+
+int MemoryManager::getFreeTotal() const {
+    return allocPolicy == ALLOC_BUDDY ? buddy.getFreeSize() : freeIndex.getFreeTotal();
+}
+
+double MemoryManager::getExternalFragmentation() const {
+    int freeTotal = getFreeTotal();
+    int largestFree = allocPolicy == ALLOC_BUDDY ? buddy.getLargestFree() : freeIndex.getLargest();
+    return freeTotal > 0 ? 100.0 * (freeTotal - largestFree) / freeTotal : 0.0;
 }
 
 /* ================= 虚拟存储与页面置换 ================= */
 
-void MemoryManager::accessPage(int page, bool write) {
-    std::cout << "\n[MMU] Request access page: " << page << (write ? " (Write)" : " (Read)") << "\n";
+const std::string MemoryManager::KERNEL_SPACE = "kernel";
+
+// 页的显示名：内核地址空间只显示页号，进程地址空间显示 pid:页号
+static std::string pageLabel(const std::string& owner, int page) {
+    if (owner == MemoryManager::KERNEL_SPACE) return std::to_string(page);
+    return owner + ":" + std::to_string(page);
+}
 
-    if (pageTable.count(page) == 0U) {
+MemoryManager::AddressSpace& MemoryManager::getAddressSpace(const std::string& owner) {
+    auto it = addressSpaces.find(owner);
+    if (it == addressSpaces.end()) {
+        AddressSpace as;
+        as.readahead.setMaxWindow(std::max(1, maxFrames / 2)); // 预读最多占一半物理帧
+        it = addressSpaces.emplace(owner, std::move(as)).first;
+    }
+    return it->second;
+}
+
+MemoryManager::PageTableEntry& MemoryManager::getPte(AddressSpace& as, int page) {
+    auto it = as.pageTable.find(page);
+    if (it == as.pageTable.end()) {
         // 首次访问，初始化页表项
-        pageTable.emplace(page, PageTableEntry{-1, false, false, fileArea.count(page) != 0U, false});
+        it = as.pageTable.emplace(page, PageTableEntry()).first;
     }
+    return it->second;
+}
 
-    PageTableEntry& pte = pageTable.at(page);
+void MemoryManager::touchFrame(int frame) {
+    // LRU 更新：移到队头，O(1)
+    auto it = lruPos.find(frame);
+    if (it != lruPos.end()) lruList.erase(it->second);
+    lruList.push_front(frame);
+    lruPos[frame] = lruList.begin();
+}
+
+void MemoryManager::accessPage(int page, bool write) {
+    accessPage(KERNEL_SPACE, page, write);
+}
+
+void MemoryManager::accessPage(const std::string& owner, int page, bool write) {
+    std::string label = pageLabel(owner, page);
+    std::cout << "\n[MMU] Request access page: " << label << (write ? " (Write)" : " (Read)") << "\n";
+    if (page < 0) {
+        std::cout << "  -> [Error] Invalid page number.\n";
+        return;
+    }
+
+    AddressSpace& as = getAddressSpace(owner);
+    PageTableEntry& pte = getPte(as, page);
+    bool tlbHit = tlb.lookup(owner, tlbKey(pte, page));
 
     if (pte.present) {
-        std::cout << "  -> HIT: Page " << page << " is in Frame " << pte.frame << "\n";
-        // LRU 更新：移到队头
-        lruList.remove(page);
-        lruList.push_front(page);
+        pageHits++;
+        std::cout << "  -> HIT: Page " << label << " is in Frame " << pte.frame
+                  << (pte.huge ? " [huge]" : "") << (tlbHit ? " (TLB hit)" : " (TLB miss)") << "\n";
+        touchPage(as, pte, page);
+
+        Frame& f = frames[pte.frame];
+        if (f.prefetched) {
+            // 预取页第一次被用到：预读有效，并沿流继续向前预读
+            f.prefetched = false;
+            as.readahead.onPrefetchUsed();
+            std::cout << "  -> [Readahead] Page " << label << " was prefetched, fault avoided.\n";
+            readahead(owner, as, page);
+        }
     } else {
-        std::cout << "  -> MISS: Page Fault! Page " << page << " not in memory.\n";
-        swapIn(page);
+        pageFaults++;
+        as.readahead.onDemandFault();
+        std::cout << "  -> MISS: Page Fault! Page " << label << " not in memory.\n";
+        swapIn(owner, page);
+        readahead(owner, as, page);
     }
 
     if (write) {
-        pte.dirty = true;
-        std::cout << "  -> Mark Page " << page << " as DIRTY.\n";
+        if (pte.cow) breakCow(owner, pte, page);
+        Frame& f = frames[pte.frame];
+        dirtyShared(f);
+        if (f.swapSlot >= 0) {
+            // 页被改写，交换区里的旧副本作废
+            swapDevice.release(f.swapSlot);
+            f.swapSlot = -1;
+        }
+        writeSeq++;
+        std::memcpy(frameData(pte.frame), &writeSeq, std::min(sizeof(writeSeq), static_cast<size_t>(pageSize)));
+        f.dirty = true;
+        std::cout << "  -> Mark Page " << label << " as DIRTY.\n";
     }
+
+    if (hugeFactor > 0) tryPromote(owner, as, page);
+    if (!tlbHit) tlb.insert(owner, tlbKey(pte, page), pte.huge ? hugeFactor : 1);
 }
 
-void MemoryManager::swapIn(int page) {
-    // 1. 检查物理帧是否已满
-    if (lruList.size() >= static_cast<size_t>(maxFrames)) {
-        // 淘汰 LRU 链表尾部（最久未使用的）
-        int victim = lruList.back();
-        lruList.pop_back();
-        std::cout << "  -> [Replace] Memory full (" << maxFrames << " frames). Selecting victim: Page " << victim << "\n";
-        swapOut(victim);
+void MemoryManager::touchPage(const AddressSpace& as, const PageTableEntry& pte, int page) {
+    if (!pte.huge) {
+        touchFrame(pte.frame);
+        return;
     }
+    // 大页在 LRU 中作为一个整体：整组帧一起变为最近使用
+    int first = page / hugeFactor * hugeFactor;
+    for (int p = first; p < first + hugeFactor; ++p) touchFrame(as.pageTable.at(p).frame);
+}
+
+/* ================= 大页 ================= */
 
-    // 2. 调入新页
-    PageTableEntry& pte = pageTable.at(page);
-    pte.frame = static_cast<int>(lruList.size()); // 简单模拟帧号
+void MemoryManager::setHugePages(int factor) {
+    if (factor < 0) factor = 0;
+    // 改变大页规格前先把现有大页全部拆回基本页
+    for (auto& space : addressSpaces) {
+        std::set<int> regions = space.second.hugeRegions;
+        for (int region : regions) demote(space.first, space.second, region, "reconfigure");
+        space.second.regionHeat.clear();
+    }
+    if (factor > maxFrames) {
+        std::cout << "[Huge] Error: Huge page of " << factor << " pages exceeds " << maxFrames << " frames.\n";
+        factor = 0;
+    }
+    hugeFactor = factor <= 1 ? 0 : factor;
+    if (hugeFactor > 0) {
+        std::cout << "[Huge] Huge pages enabled: " << hugeFactor << " x " << pageSize
+                  << " = " << hugeFactor * pageSize << " bytes.\n";
+    } else {
+        std::cout << "[Huge] Huge pages disabled.\n";
+    }
+}
+
+// 提升条件：区域足够热，且每一页都驻留、私有（非共享/写保护）、不是文件映射页
+void MemoryManager::tryPromote(const std::string& owner, AddressSpace& as, int page) {
+    int region = page / hugeFactor;
+    if (as.hugeRegions.count(region)) return;
+    if (++as.regionHeat[region] < HUGE_PROMOTE_HEAT * hugeFactor) return;
+
+    int first = region * hugeFactor;
+    for (int p = first; p < first + hugeFactor; ++p) {
+        auto it = as.pageTable.find(p);
+        if (it == as.pageTable.end()) return;
+        const PageTableEntry& pte = it->second;
+        if (!pte.present || pte.fileBacked || pte.cow || pte.shm || frames[pte.frame].mappers.size() != 1U) return;
+    }
+
+    // 1. 选一组对齐的物理帧：不能包含别的大页，优先已经放着本区域页面最多的一组（搬移最少）
+    int bestBase = -1;
+    int bestOwned = -1;
+    for (int base = 0; base + hugeFactor <= maxFrames; base += hugeFactor) {
+        int owned = 0;
+        bool usable = true;
+        for (int f = base; f < base + hugeFactor && f < static_cast<int>(frames.size()); ++f) {
+            if (frames[f].huge) {
+                usable = false;
+                break;
+            }
+            if (!frames[f].mappers.empty() && frames[f].mappers.front().first == owner &&
+                frames[f].mappers.front().second / hugeFactor == region) {
+                owned++;
+            }
+        }
+        if (usable && owned > bestOwned) {
+            bestBase = base;
+            bestOwned = owned;
+        }
+    }
+    if (bestBase < 0) return;
+
+    // 2. 帧组还没被创建过的部分先补成空闲帧
+    while (static_cast<int>(frames.size()) < bestBase + hugeFactor) {
+        frames.emplace_back();
+        freeFrames.push_back(static_cast<int>(frames.size()) - 1);
+    }
+
+    // 3. 第 i 页搬到第 i 个帧；占着目标帧的其他页换到被腾出的帧上
+    int copies = 0;
+    for (int i = 0; i < hugeFactor; ++i) {
+        int target = bestBase + i;
+        int current = as.pageTable.at(first + i).frame;
+        if (current == target) continue;
+        copies += frames[target].mappers.empty() ? 1 : 2;
+        exchangeFrames(current, target);
+    }
+
+    for (int p = first; p < first + hugeFactor; ++p) {
+        PageTableEntry& pte = as.pageTable.at(p);
+        pte.huge = true;
+        frames[pte.frame].huge = true;
+        tlb.invalidate(owner, p);
+    }
+    as.hugeRegions.insert(region);
+    as.regionHeat.erase(region);
+    touchPage(as, as.pageTable.at(first), first);
+    promotions++;
+    promoteCopies += copies;
+    std::cout << "  -> [Huge] Promoted pages " << pageLabel(owner, first) << ".." << first + hugeFactor - 1
+              << " to a huge page (Frames " << bestBase << ".." << bestBase + hugeFactor - 1
+              << ", " << copies << " frame copies).\n";
+}
+
+void MemoryManager::demote(const std::string& owner, AddressSpace& as, int region, const char* reason) {
+    int first = region * hugeFactor;
+    tlb.invalidate(owner, -region - 1);
+    for (int p = first; p < first + hugeFactor; ++p) {
+        PageTableEntry& pte = as.pageTable.at(p);
+        pte.huge = false;
+        frames[pte.frame].huge = false;
+    }
+    as.hugeRegions.erase(region);
+    demotions++;
+    std::cout << "  -> [Huge] Demoted huge page " << pageLabel(owner, first) << ".." << first + hugeFactor - 1
+              << " to base pages (" << reason << ").\n";
+}
+
+// 交换两个物理帧的内容与归属（任一方可以是空闲帧），并修正页表、LRU 位置与空闲栈
+void MemoryManager::exchangeFrames(int a, int b) {
+    std::swap(frames[a], frames[b]);
+    std::swap_ranges(frameData(a), frameData(a) + pageSize, frameData(b));
+
+    for (int frame : {a, b}) {
+        for (const Mapping& m : frames[frame].mappers) {
+            addressSpaces.at(m.first).pageTable.at(m.second).frame = frame;
+            tlb.invalidate(m.first, m.second);
+        }
+        if (frames[frame].shm) frames[frame].shm->frame[static_cast<size_t>(frames[frame].shmPage)] = frame;
+    }
+
+    auto ia = lruPos.find(a);
+    auto ib = lruPos.find(b);
+    std::list<int>::iterator posA = ia != lruPos.end() ? ia->second : lruList.end();
+    std::list<int>::iterator posB = ib != lruPos.end() ? ib->second : lruList.end();
+    lruPos.erase(a);
+    lruPos.erase(b);
+    // 原来 a 所在的链表节点现在代表 b，反之亦然
+    if (posA != lruList.end()) {
+        *posA = b;
+        lruPos[b] = posA;
+    }
+    if (posB != lruList.end()) {
+        *posB = a;
+        lruPos[a] = posB;
+    }
+    for (int& f : freeFrames) {
+        if (f == a) f = b;
+        else if (f == b) f = a;
+    }
+}
+
+// 写时复制缺页：帧仍被共享则复制一份私有帧，已独占则直接解除写保护
+void MemoryManager::breakCow(const std::string& owner, PageTableEntry& pte, int page) {
+    int oldFrame = pte.frame;
+    if (frames[oldFrame].mappers.size() <= 1U) {
+        pte.cow = false;
+        cowReuses++;
+        std::cout << "  -> [COW] Page " << pageLabel(owner, page) << " no longer shared, write-enable in place.\n";
+        return;
+    }
+
+    // 分配新帧可能触发淘汰，先把源帧置为最近使用，避免它被选为牺牲者
+    touchFrame(oldFrame);
+    int newFrame = allocFrame();
+
+    unmapFrame(oldFrame, {owner, page});
+    tlb.invalidate(owner, page);
+    frames[newFrame].mappers = {{owner, page}};
+    frames[newFrame].dirty = frames[oldFrame].dirty;
+    std::memcpy(frameData(newFrame), frameData(oldFrame), static_cast<size_t>(pageSize));
+    frames[newFrame].prefetched = false;
+    touchFrame(newFrame);
+
+    pte.frame = newFrame;
+    pte.cow = false;
+    cowFaults++;
+    std::cout << "  -> [COW] Write fault: copied Frame " << oldFrame << " -> Frame " << newFrame
+              << " for Page " << pageLabel(owner, page) << ".\n";
+}
+
+void MemoryManager::readahead(const std::string& owner, AddressSpace& as, int page) {
+    if (!readaheadEnabled) return;
+
+    std::vector<int> candidates = as.readahead.onAccess(page);
+    std::vector<int> loaded;
+    for (int p : candidates) {
+        PageTableEntry& pte = getPte(as, p);
+        if (pte.present) continue;
+        swapIn(owner, p, true);
+        as.readahead.onPrefetchIssued();
+        loaded.push_back(p);
+    }
+    // 预取页插在队头会挤到当前页前面，把当前页重新置为最近使用
+    if (!loaded.empty()) touchFrame(as.pageTable.at(page).frame);
+
+    if (!loaded.empty()) {
+        std::cout << "  -> [Readahead] Prefetched pages:";
+        for (int p : loaded) std::cout << " " << p;
+        std::cout << " (stride=" << as.readahead.getStride()
+                  << ", window=" << as.readahead.getWindow() << ")\n";
+    }
+}
+
+int MemoryManager::allocFrame() {
+    // 1. 有空闲帧直接使用
+    if (!freeFrames.empty()) {
+        int frame = freeFrames.back();
+        freeFrames.pop_back();
+        return frame;
+    }
+    if (static_cast<int>(frames.size()) < maxFrames) {
+        frames.emplace_back();
+        return static_cast<int>(frames.size()) - 1;
+    }
+
+    // 2. 物理帧已满：淘汰 LRU 链表尾部（最久未使用的）
+    int victim = lruList.back();
+    const Mapping& m = frames[victim].mappers.front();
+    if (frames[victim].huge) {
+        // 内存紧张：先把大页拆回基本页，只淘汰其中最久未用的那一页
+        demote(m.first, addressSpaces.at(m.first), m.second / hugeFactor, "memory pressure");
+    }
+    std::cout << "  -> [Replace] Memory full (" << maxFrames << " frames). Selecting victim: Page "
+              << pageLabel(m.first, m.second) << "\n";
+    swapOut(victim);
+    return victim;
+}
+
+// 解除某个页对帧的映射；最后一个映射者离开时帧回到空闲栈
+void MemoryManager::unmapFrame(int frame, const Mapping& m) {
+    Frame& f = frames[frame];
+    f.mappers.erase(std::remove(f.mappers.begin(), f.mappers.end(), m), f.mappers.end());
+    if (!f.mappers.empty()) return;
+    if (f.shm) saveSharedPage(frame); // 段还在：内容留到交换区，下一个挂接者缺页时读回
+
+    swapDevice.release(f.swapSlot);
+    lruList.erase(lruPos.at(frame));
+    lruPos.erase(frame);
+    f = Frame();
+    freeFrames.push_back(frame);
+}
+
+void MemoryManager::swapIn(const std::string& owner, int page, bool prefetch) {
+    PageTableEntry& pte = getPte(getAddressSpace(owner), page);
+    if (pte.shm) {
+        faultShared(owner, page, pte, prefetch);
+        return;
+    }
+    int frame = allocFrame();
+
+    // 调入新页
+    int slot = pte.swapSlot;
+    pte.frame = frame;
     pte.present = true;
     pte.inSwap = false;
+    pte.swapSlot = -1;
 
-    // 3. 加入 LRU 队头
-    lruList.push_front(page);
+    frames[frame].mappers = {{owner, page}};
+    frames[frame].swapSlot = -1;
+    frames[frame].dirty = false;
+    frames[frame].prefetched = prefetch;
 
+    // 加入 LRU 队头
+    touchFrame(frame);
+
+    std::string label = pageLabel(owner, page);
     if (pte.fileBacked) {
-        std::cout << "  -> [IO] Loaded Page " << page << " from File System.\n";
-    } else if (swapArea.count(page)) {
-        std::cout << "  -> [IO] Loaded Page " << page << " from Swap Area.\n";
-        swapArea.erase(page);
+        readFilePage(pte, frameData(frame));
+        if (!prefetch) {
+            std::cout << "  -> [IO] Loaded Page " << label << " from file '" << pte.file->name
+                      << "' (block " << pte.file->disk->getPhysicalBlock(pte.file->name, pte.fileOffset / BLOCK_SIZE)
+                      << ").\n";
+        }
+    } else if (slot >= 0) {
+        swapDevice.read(slot, frameData(frame));
+        if (!prefetch) std::cout << "  -> [IO] Loaded Page " << label << " from Swap Area (slot " << slot << ").\n";
+        // 页表对槽位的引用转给帧：页保持干净时再次换出可直接复用该副本。
+        // 读入后本页拥有私有帧，不再需要写保护
+        frames[frame].swapSlot = slot;
+        pte.cow = false;
     } else {
-        std::cout << "  -> [Alloc] Zero-filled new Page " << page << ".\n";
+        std::memset(frameData(frame), 0, static_cast<size_t>(pageSize));
+        if (!prefetch) std::cout << "  -> [Alloc] Zero-filled new Page " << label << ".\n";
     }
 }
 
-void MemoryManager::swapOut(int page) {
-    PageTableEntry& pte = pageTable.at(page);
-    pte.present = false;
+void MemoryManager::swapOut(int frame) {
+    Frame& f = frames[frame];
+    const Mapping& first = f.mappers.front();
+    std::string label = pageLabel(first.first, first.second);
+    if (f.mappers.size() > 1U) label += " (+" + std::to_string(f.mappers.size() - 1) + " shared)";
 
-    if (pte.fileBacked) {
-        if (pte.dirty) std::cout << "  -> [IO] Write back dirty Page " << page << " to File.\n";
-        else std::cout << "  -> [Drop] Page " << page << " is clean (file-backed), simply drop.\n";
+    if (f.prefetched) {
+        // 预取了却没用上就被淘汰：缩小预读窗口
+        getAddressSpace(first.first).readahead.onPrefetchWasted();
+    }
+
+    const PageTableEntry& firstPte = addressSpaces.at(first.first).pageTable.at(first.second);
+    int slot = -1;
+    if (f.shm) {
+        saveSharedPage(frame); // 段页的副本记在段里，页表项只标记为不在内存
+    } else if (firstPte.fileBacked) {
+        if (f.dirty) {
+            writeFilePage(firstPte, frameData(frame));
+            std::cout << "  -> [IO] Write back dirty Page " << label << " to file '" << firstPte.file->name << "'.\n";
+        } else {
+            std::cout << "  -> [Drop] Page " << label << " is clean (file-backed), simply drop.\n";
+        }
+    } else if (!f.dirty && f.swapSlot >= 0) {
+        // 干净页且交换区副本仍有效：不产生写 IO，帧的槽位引用转给第一个映射者
+        slot = f.swapSlot;
+        std::cout << "  -> [Swap] Page " << label << " is clean, reuse swap copy (slot " << slot << ").\n";
     } else {
-        std::cout << "  -> [Swap] Swapped out Page " << page << " to Swap Area.\n";
-        swapArea.insert(page);
-        pte.inSwap = true;
+        swapDevice.release(f.swapSlot);
+        slot = swapDevice.allocSlot();
+        swapDevice.writeAsync(slot, frameData(frame));
+        std::cout << "  -> [Swap] Swapped out Page " << label << " to Swap Area (slot " << slot << ", queued).\n";
+    }
+
+    // 共享帧只写出一次，所有映射者的页表都指向同一个交换槽位
+    bool firstRef = true;
+    for (const Mapping& m : f.mappers) {
+        PageTableEntry& pte = addressSpaces.at(m.first).pageTable.at(m.second);
+        tlb.invalidate(m.first, m.second);
+        pte.present = false;
+        pte.frame = -1;
+        if (slot >= 0) {
+            pte.inSwap = true;
+            pte.swapSlot = slot;
+            if (!firstRef) swapDevice.addRef(slot);
+            firstRef = false;
+        }
+    }
+
+    lruList.erase(lruPos.at(frame));
+    lruPos.erase(frame);
+    f = Frame();
+}
+
+void MemoryManager::releaseAddressSpace(const std::string& owner) {
+    auto it = addressSpaces.find(owner);
+    if (it == addressSpaces.end()) return;
+
+    // 先分离共享内存段：已删除的段在最后一个进程离开时不必再保存页内容
+    std::vector<std::string> orphaned;
+    for (auto& pair : segments) {
+        ShmSegment& seg = pair.second;
+        if (seg.attached.erase(owner) == 0U) continue;
+        seg.detaches++;
+        if (seg.removed && seg.attached.empty()) orphaned.push_back(seg.name);
+    }
+    for (const auto& pair : it->second.pageTable) dropPage(owner, pair.first, pair.second);
+    addressSpaces.erase(it);
+    tlb.flush(owner);
+    for (const std::string& name : orphaned) destroySegment(name);
+}
+
+// 丢弃一个页表项占用的帧与交换槽位；文件页的最后一个映射者负责写回脏数据
+void MemoryManager::dropPage(const std::string& owner, int page, const PageTableEntry& pte) {
+    if (pte.present) {
+        const Frame& f = frames[pte.frame];
+        if (pte.fileBacked && f.dirty && f.mappers.size() == 1U) {
+            writeFilePage(pte, frameData(pte.frame));
+            std::cout << "  -> [IO] Write back dirty Page " << pageLabel(owner, page)
+                      << " to file '" << pte.file->name << "'.\n";
+        }
+        unmapFrame(pte.frame, {owner, page});
+    }
+    if (pte.inSwap) swapDevice.release(pte.swapSlot);
+}
+
+/* ================= 内存映射文件 ================= */
+
+int MemoryManager::mapFile(const std::string& owner, int startPage, StorageManager& disk, const std::string& fileName) {
+    int size = disk.getFileSize(fileName);
+    if (size < 0) {
+        std::cout << "[mmap] Error: File '" << fileName << "' not found.\n";
+        return -1;
+    }
+    if (startPage < 0) {
+        std::cout << "[mmap] Error: Invalid start page.\n";
+        return -1;
+    }
+
+    int pages = (size + pageSize - 1) / pageSize;
+    if (pages == 0) {
+        std::cout << "[mmap] Error: File '" << fileName << "' is empty.\n";
+        return -1;
+    }
+    AddressSpace& as = getAddressSpace(owner);
+    for (int p = startPage; p < startPage + pages; ++p) {
+        if (as.pageTable.count(p)) {
+            std::cout << "[mmap] Error: Page " << pageLabel(owner, p) << " is already in use.\n";
+            return -1;
+        }
+    }
+
+    // 只建立页表项，不读任何数据：真正的读盘发生在第一次缺页时
+    // 记录绝对路径，之后切换当前目录不影响映射
+    auto mapping = std::make_shared<const FileMapping>(FileMapping{&disk, disk.absolutePath(fileName)});
+    for (int i = 0; i < pages; ++i) {
+        PageTableEntry pte;
+        pte.fileBacked = true;
+        pte.file = mapping;
+        pte.fileOffset = i * pageSize;
+        as.pageTable.emplace(startPage + i, pte);
+    }
+    std::cout << "[mmap] Mapped file '" << fileName << "' (" << size << " bytes, "
+              << disk.getFileBlockCount(fileName) << " block(s)) to pages "
+              << pageLabel(owner, startPage) << ".." << startPage + pages - 1 << ".\n";
+    return pages;
+}
+
+bool MemoryManager::unmapFile(const std::string& owner, const std::string& fileName) {
+    auto it = addressSpaces.find(owner);
+    if (it == addressSpaces.end()) return false;
+
+    auto& table = it->second.pageTable;
+    int removed = 0;
+    for (auto pit = table.begin(); pit != table.end();) {
+        if (pit->second.fileBacked && pit->second.file->name == pit->second.file->disk->absolutePath(fileName)) {
+            tlb.invalidate(owner, pit->first);
+            dropPage(owner, pit->first, pit->second);
+            pit = table.erase(pit);
+            removed++;
+        } else {
+            ++pit;
+        }
+    }
+    if (removed == 0) {
+        std::cout << "[mmap] Error: File '" << fileName << "' is not mapped.\n";
+        return false;
+    }
+    std::cout << "[mmap] Unmapped " << removed << " page(s) of '" << fileName << "'.\n";
+    return true;
+}
+
+int MemoryManager::getMappedPages(const std::string& owner) const {
+    auto it = addressSpaces.find(owner);
+    if (it == addressSpaces.end()) return 0;
+    int count = 0;
+    for (const auto& pair : it->second.pageTable) {
+        if (pair.second.fileBacked) count++;
+    }
+    return count;
+}
+
+bool MemoryManager::isFileMapped(const std::string& path) const {
+    for (const auto& space : addressSpaces) {
+        for (const auto& pair : space.second.pageTable) {
+            if (pair.second.fileBacked && pair.second.file->name == path) return true;
+        }
+    }
+    return false;
+}
+
+// 页与磁盘块的大小不一定相同：按字节区间逐块拷贝，超出文件末尾的部分为零
+void MemoryManager::readFilePage(const PageTableEntry& pte, char* out) {
+    std::memset(out, 0, static_cast<size_t>(pageSize));
+    char buf[BLOCK_SIZE];
+    int end = pte.fileOffset + pageSize;
+    for (int off = pte.fileOffset; off < end;) {
+        int inBlock = off % BLOCK_SIZE;
+        int len = std::min(BLOCK_SIZE - inBlock, end - off);
+        if (!pte.file->disk->readFileBlock(pte.file->name, off / BLOCK_SIZE, buf)) break;
+        std::memcpy(out + (off - pte.fileOffset), buf + inBlock, static_cast<size_t>(len));
+        off += len;
+    }
+}
+
+void MemoryManager::writeFilePage(const PageTableEntry& pte, const char* data) {
+    char buf[BLOCK_SIZE];
+    int end = pte.fileOffset + pageSize;
+    for (int off = pte.fileOffset; off < end;) {
+        int blockNo = off / BLOCK_SIZE;
+        int inBlock = off % BLOCK_SIZE;
+        int len = std::min(BLOCK_SIZE - inBlock, end - off);
+        // 页只覆盖块的一部分时先读出整块再改写
+        if (!pte.file->disk->readFileBlock(pte.file->name, blockNo, buf)) break;
+        std::memcpy(buf + inBlock, data + (off - pte.fileOffset), static_cast<size_t>(len));
+        pte.file->disk->writeFileBlock(pte.file->name, blockNo, buf);
+        off += len;
+    }
+}
+
+int MemoryManager::forkAddressSpace(const std::string& parent, const std::string& child) {
+    if (parent == child) return 0;
+    releaseAddressSpace(child); // 子地址空间应为空
+    AddressSpace& src = getAddressSpace(parent);
+    AddressSpace& dst = getAddressSpace(child);
+    // 共享后的帧不再是私有的，大页先拆开；父进程的页变为写保护，旧的翻译作废
+    std::set<int> regions = src.hugeRegions;
+    for (int region : regions) demote(parent, src, region, "fork");
+    tlb.flush(parent);
+
+    // 只复制页表：O(页表大小)，与内存容量无关
+    int shared = 0;
+    for (auto& pair : src.pageTable) {
+        PageTableEntry& pte = pair.second;
+        PageTableEntry copy = pte;
+        if (!pte.fileBacked && !pte.shm) {
+            // 匿名页双方都写保护，谁先写谁复制；文件页按共享映射处理，不需要 COW
+            pte.cow = true;
+            copy.cow = true;
+        }
+        if (pte.present) {
+            frames[pte.frame].mappers.push_back({child, pair.first});
+            shared++;
+        } else if (pte.inSwap) {
+            swapDevice.addRef(pte.swapSlot);
+            shared++;
+        }
+        dst.pageTable.emplace(pair.first, copy);
+    }
+    // 子进程继承父进程挂接的共享内存段
+    for (auto& pair : segments) {
+        auto at = pair.second.attached.find(parent);
+        if (at == pair.second.attached.end()) continue;
+        pair.second.attached[child] = at->second;
+        pair.second.attaches++;
+    }
+    forks++;
+    return shared;
+}
+
+/* ================= 共享内存段 ================= */
+
+bool MemoryManager::createSegment(const std::string& name, int pages) {
+    if (pages <= 0 || pages > MAX_SEGMENT_PAGES) {
+        std::cout << "[SHM] Error: Segment must have 1-" << MAX_SEGMENT_PAGES << " page(s).\n";
+        return false;
+    }
+    if (segments.count(name)) {
+        std::cout << "[SHM] Error: Segment '" << name << "' already exists.\n";
+        return false;
+    }
+    // 不预先分配帧：每页第一次被访问时才清零调入
+    ShmSegment& seg = segments[name];
+    seg.name = name;
+    seg.pages = pages;
+    seg.frame.assign(static_cast<size_t>(pages), -1);
+    seg.swapSlot.assign(static_cast<size_t>(pages), -1);
+    std::cout << "[SHM] Segment '" << name << "' created: " << pages << " page(s) (" << segmentBytes(seg) << " bytes).\n";
+    return true;
+}
+
+int MemoryManager::attachSegment(const std::string& owner, const std::string& name, int startPage) {
+    auto it = segments.find(name);
+    if (it == segments.end() || it->second.removed) {
+        std::cout << "[SHM] Error: Segment '" << name << "' not found.\n";
+        return -1;
+    }
+    ShmSegment& seg = it->second;
+    if (seg.attached.count(owner)) {
+        std::cout << "[SHM] Error: Segment '" << name << "' is already attached to " << owner << ".\n";
+        return -1;
+    }
+    if (startPage < 0 || startPage > INT_MAX - seg.pages) {
+        std::cout << "[SHM] Error: Invalid start page.\n";
+        return -1;
+    }
+    AddressSpace& as = getAddressSpace(owner);
+    for (int p = startPage; p < startPage + seg.pages; ++p) {
+        if (as.pageTable.count(p)) {
+            std::cout << "[SHM] Error: Page " << pageLabel(owner, p) << " is already in use.\n";
+            return -1;
+        }
+    }
+
+    // 只建立页表项：O(页数)，与段里的数据量无关
+    for (int i = 0; i < seg.pages; ++i) {
+        PageTableEntry pte;
+        pte.shm = &seg;
+        pte.shmPage = i;
+        as.pageTable.emplace(startPage + i, pte);
+    }
+    seg.attached[owner] = startPage;
+    seg.attaches++;
+    std::cout << "[SHM] Attached segment '" << name << "' to pages " << pageLabel(owner, startPage) << ".."
+              << startPage + seg.pages - 1 << " (" << seg.attached.size() << " attachment(s)).\n";
+    return seg.pages;
+}
+
+void MemoryManager::unmapSegment(const std::string& owner, ShmSegment& seg, int startPage) {
+    auto& table = addressSpaces.at(owner).pageTable;
+    for (int p = startPage; p < startPage + seg.pages; ++p) {
+        auto it = table.find(p);
+        if (it == table.end() || it->second.shm != &seg) continue;
+        tlb.invalidate(owner, p);
+        dropPage(owner, p, it->second);
+        table.erase(it);
+    }
+}
+
+bool MemoryManager::detachSegment(const std::string& owner, const std::string& name) {
+    auto it = segments.find(name);
+    if (it == segments.end() || !it->second.attached.count(owner)) {
+        std::cout << "[SHM] Error: Segment '" << name << "' is not attached to " << owner << ".\n";
+        return false;
+    }
+    ShmSegment& seg = it->second;
+    int startPage = seg.attached.at(owner);
+    seg.attached.erase(owner);
+    seg.detaches++;
+    unmapSegment(owner, seg, startPage);
+    std::cout << "[SHM] Detached segment '" << name << "' from " << owner << " (" << seg.attached.size()
+              << " attachment(s) left).\n";
+    if (seg.removed && seg.attached.empty()) destroySegment(name);
+    return true;
+}
+
+// 引用计数式释放：仍有进程挂接时只做标记，最后一个进程分离时释放
+bool MemoryManager::removeSegment(const std::string& name) {
+    auto it = segments.find(name);
+    if (it == segments.end() || it->second.removed) {
+        std::cout << "[SHM] Error: Segment '" << name << "' not found.\n";
+        return false;
+    }
+    it->second.removed = true;
+    if (it->second.attached.empty()) {
+        destroySegment(name);
+    } else {
+        std::cout << "[SHM] Segment '" << name << "' marked for removal, freed when the last of "
+                  << it->second.attached.size() << " process(es) detaches.\n";
+    }
+    return true;
+}
+
+// 调用时已没有进程挂接，段的页都不在内存，只需释放交换区副本
+void MemoryManager::destroySegment(const std::string& name) {
+    auto it = segments.find(name);
+    for (int slot : it->second.swapSlot) swapDevice.release(slot);
+    segments.erase(it);
+    std::cout << "[SHM] Segment '" << name << "' destroyed.\n";
+}
+
+void MemoryManager::faultShared(const std::string& owner, int page, PageTableEntry& pte, bool prefetch) {
+    ShmSegment& seg = *pte.shm;
+    size_t index = static_cast<size_t>(pte.shmPage);
+    std::string label = pageLabel(owner, page);
+    int frame = seg.frame[index];
+    if (frame >= 0) {
+        // 其他进程已经调入：只把帧加入本进程页表，没有 I/O 也没有复制
+        frames[frame].mappers.push_back({owner, page});
+        pte.frame = frame;
+        pte.present = true;
+        touchFrame(frame);
+        seg.sharedFaults++;
+        if (!prefetch) {
+            std::cout << "  -> [SHM] Page " << label << " mapped to Frame " << frame << " of segment '" << seg.name
+                      << "' (already resident, no copy).\n";
+        }
+        return;
+    }
+
+    frame = allocFrame();
+    pte.frame = frame;
+    pte.present = true;
+    Frame& f = frames[frame];
+    f.mappers = {{owner, page}};
+    f.swapSlot = -1;
+    f.dirty = false;
+    f.prefetched = prefetch;
+    f.shm = &seg;
+    f.shmPage = pte.shmPage;
+    seg.frame[index] = frame;
+    seg.majorFaults++;
+    touchFrame(frame);
+    if (seg.swapSlot[index] >= 0) {
+        swapDevice.read(seg.swapSlot[index], frameData(frame));
+        if (!prefetch) {
+            std::cout << "  -> [IO] Loaded shared Page " << label << " of segment '" << seg.name
+                      << "' from Swap Area (slot " << seg.swapSlot[index] << ").\n";
+        }
+    } else {
+        std::memset(frameData(frame), 0, static_cast<size_t>(pageSize));
+        if (!prefetch) std::cout << "  -> [SHM] Zero-filled shared Page " << label << " of segment '" << seg.name << "'.\n";
     }
-    pte.dirty = false;
+}
+
+void MemoryManager::dirtyShared(Frame& f) {
+    if (!f.shm) return;
+    int& slot = f.shm->swapSlot[static_cast<size_t>(f.shmPage)];
+    swapDevice.release(slot);
+    slot = -1;
+}
+
+void MemoryManager::saveSharedPage(int frame) {
+    Frame& f = frames[frame];
+    ShmSegment& seg = *f.shm;
+    size_t index = static_cast<size_t>(f.shmPage);
+    seg.frame[index] = -1;
+    if (seg.removed && seg.attached.empty()) return; // 段即将释放，内容不再需要
+
+    if (!f.dirty && seg.swapSlot[index] >= 0) {
+        std::cout << "  -> [Swap] Shared Page " << index << " of segment '" << seg.name
+                  << "' is clean, reuse swap copy (slot " << seg.swapSlot[index] << ").\n";
+        return;
+    }
+    swapDevice.release(seg.swapSlot[index]);
+    int slot = swapDevice.allocSlot();
+    swapDevice.writeAsync(slot, frameData(frame));
+    seg.swapSlot[index] = slot;
+    std::cout << "  -> [Swap] Saved shared Page " << index << " of segment '" << seg.name
+              << "' to Swap Area (slot " << slot << ", queued).\n";
+}
+
+char* MemoryManager::segmentPage(const std::string& owner, const ShmSegment& seg, int startPage, int index, bool write) {
+    int page = startPage + index;
+    PageTableEntry& pte = addressSpaces.at(owner).pageTable.at(page);
+    if (pte.present) {
+        pageHits++;
+        touchFrame(pte.frame);
+    } else {
+        pageFaults++;
+        std::cout << "  -> MISS: Page Fault! Shared Page " << pageLabel(owner, page) << " of segment '" << seg.name
+                  << "' not mapped.\n";
+        swapIn(owner, page);
+    }
+    Frame& f = frames[pte.frame];
+    f.prefetched = false;
+    if (write) {
+        dirtyShared(f);
+        f.dirty = true;
+    }
+    return frameData(pte.frame);
+}
+
+int MemoryManager::writeSegment(const std::string& owner, const std::string& name, int offset, const std::string& data) {
+    auto it = segments.find(name);
+    if (it == segments.end() || !it->second.attached.count(owner)) {
+        std::cout << "[SHM] Error: Segment '" << name << "' is not attached to " << owner << ".\n";
+        return -1;
+    }
+    ShmSegment& seg = it->second;
+    int len = static_cast<int>(data.length());
+    if (offset < 0 || static_cast<long long>(offset) + len > segmentBytes(seg)) {
+        std::cout << "[SHM] Error: Write outside segment '" << name << "' (" << segmentBytes(seg) << " bytes).\n";
+        return -1;
+    }
+    int startPage = seg.attached.at(owner);
+    for (int done = 0; done < len;) {
+        int off = offset + done;
+        int n = std::min(len - done, pageSize - off % pageSize);
+        char* page = segmentPage(owner, seg, startPage, off / pageSize, true);
+        std::memcpy(page + off % pageSize, data.data() + done, static_cast<size_t>(n));
+        done += n;
+    }
+    seg.bytesWritten += len;
+    return len;
+}
+
+int MemoryManager::readSegment(const std::string& owner, const std::string& name, int offset, int len, std::string& out) {
+    auto it = segments.find(name);
+    if (it == segments.end() || !it->second.attached.count(owner)) {
+        std::cout << "[SHM] Error: Segment '" << name << "' is not attached to " << owner << ".\n";
+        return -1;
+    }
+    ShmSegment& seg = it->second;
+    if (offset < 0 || len < 0 || offset >= segmentBytes(seg)) return 0;
+    len = static_cast<int>(std::min<long long>(len, segmentBytes(seg) - offset));
+    int startPage = seg.attached.at(owner);
+    out.assign(static_cast<size_t>(len), '\0');
+    for (int done = 0; done < len;) {
+        int off = offset + done;
+        int n = std::min(len - done, pageSize - off % pageSize);
+        const char* page = segmentPage(owner, seg, startPage, off / pageSize, false);
+        std::memcpy(&out[static_cast<size_t>(done)], page + off % pageSize, static_cast<size_t>(n));
+        done += n;
+    }
+    seg.bytesRead += len;
+    return len;
+}
+
+void MemoryManager::printSegments() const {
+    std::cout << "\n--- Shared Memory Segments ---\n";
+    if (segments.empty()) std::cout << "(No segments)\n";
+    for (const auto& pair : segments) {
+        const ShmSegment& seg = pair.second;
+        int resident = 0;
+        int swapped = 0;
+        for (int i = 0; i < seg.pages; ++i) {
+            if (seg.frame[static_cast<size_t>(i)] >= 0) resident++;
+            else if (seg.swapSlot[static_cast<size_t>(i)] >= 0) swapped++;
+        }
+        std::cout << "Segment '" << seg.name << "': " << seg.pages << " page(s) (" << segmentBytes(seg)
+                  << " bytes) | resident " << resident << ", in swap " << swapped << " | attached "
+                  << seg.attached.size() << ":";
+        for (const auto& at : seg.attached) std::cout << " " << pageLabel(at.first, at.second);
+        if (seg.removed) std::cout << " [marked for removal]";
+        std::cout << "\n    attaches " << seg.attaches << ", detaches " << seg.detaches << " | faults: "
+                  << seg.majorFaults << " loaded, " << seg.sharedFaults << " mapped from another process (no copy)"
+                  << " | written " << seg.bytesWritten << " B, read " << seg.bytesRead << " B\n";
+    }
+    std::cout << "------------------------------\n";
 }
 
 // 可视化状态打印
@@ -142,27 +1114,135 @@ void MemoryManager::printStatus() const {
     std::cout << "\n===== Memory Manager Status =====\n";
     
     // 1. 连续分配状态 (用于 exec/process loading)
-    std::cout << "[Partitions (Continuous Alloc)] Total: " << totalSize << "\n";
+    std::cout << "[Partitions (Continuous Alloc)] Total: " << totalSize
+              << " | Policy: " << policyName(allocPolicy) << "\n";
     std::cout << "  Used Blocks:\n";
     if (usedBlocks.empty()) std::cout << "    (None)\n";
     for (auto& pair : usedBlocks) {
         std::cout << "    | Start: " << std::setw(4) << pair.second.start 
-                  << " | Size: " << std::setw(4) << pair.second.size << " |\n";
+                  << " | Size: " << std::setw(4) << pair.second.size << " |";
+        if (pair.second.pinned) std::cout << " (pinned)";
+        if (allocPolicy == ALLOC_BUDDY) std::cout << " Block: " << buddy.blockSizeOf(pair.first);
+        std::cout << "\n";
     }
+    if (allocPolicy == ALLOC_BUDDY) {
+        buddy.printStatus();
+    } else {
+        std::cout << "  Free Blocks (" << freeIndex.count() << "):\n    ";
+        if (freeIndex.count() == 0U) std::cout << "(None)";
+        for (const auto& pair : freeIndex.blocks()) {
+            std::cout << "[" << pair.first << "+" << pair.second << "] ";
+        }
+        std::cout << "\n";
+    }
+    printFragmentation();
+    slabAllocator.printStatus();
     
     // 2. 分页状态 (用于 access page demo)
-    std::cout << "\n[Paging System (LRU)] Frames Used: " << lruList.size() << "/" << maxFrames << "\n";
+    std::cout << "\n[Paging System (LRU)] Frames Used: " << lruList.size() << "/" << maxFrames
+              << " | Hits: " << pageHits << " | Faults: " << pageFaults << "\n";
     std::cout << "  Physical Frames (LRU Order: Most Recent -> Least Recent):\n  ";
     if (lruList.empty()) std::cout << "(Empty)";
-    for (int page : lruList) {
-        std::cout << "[Page " << page << "]";
-        if (pageTable.at(page).dirty) std::cout << "*"; // 脏页标记
+    for (int frame : lruList) {
+        const Frame& f = frames[frame];
+        const Mapping& m = f.mappers.front();
+        std::cout << "[Page " << pageLabel(m.first, m.second);
+        if (f.mappers.size() > 1U) std::cout << " x" << f.mappers.size(); // 共享帧的映射数
+        std::cout << "]";
+        if (f.dirty) std::cout << "*";       // 脏页标记
+        if (f.prefetched) std::cout << "(ra)"; // 预取未用
+        if (f.huge) std::cout << "(H)";        // 大页的一部分
         std::cout << " -> ";
     }
     std::cout << "END\n";
 
     std::cout << "  Swap Area: { ";
-    for (int p : swapArea) std::cout << p << " ";
+    for (const auto& space : addressSpaces) {
+        for (const auto& pair : space.second.pageTable) {
+            if (pair.second.inSwap) {
+                std::cout << pageLabel(space.first, pair.first) << "@" << pair.second.swapSlot << " ";
+            }
+        }
+    }
     std::cout << "}\n";
+    swapDevice.printStatus();
+
+    // TLB 与大页：reach = 当前表项覆盖的页数 x 页大小
+    std::cout << std::fixed << std::setprecision(1)
+              << "  TLB: " << tlb.size() << "/" << tlb.getCapacity() << " entries | Hits: " << tlb.getHits()
+              << " | Misses: " << tlb.getMisses() << " (" << tlb.hitRate() << "% hit)"
+              << " | Reach: " << tlb.reachPages() << " page(s) = " << tlb.reachPages() * pageSize << " bytes\n";
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+    if (hugeFactor > 0 || promotions > 0) {
+        size_t resident = 0;
+        for (const auto& space : addressSpaces) resident += space.second.hugeRegions.size();
+        std::cout << "  Huge Pages (" << (hugeFactor > 0 ? std::to_string(hugeFactor) + " pages each" : "off")
+                  << "): resident " << resident << " | promotions " << promotions
+                  << " | demotions " << demotions << " | frame copies " << promoteCopies << "\n";
+    }
+
+    // 内存映射文件：每个地址空间映射了哪些文件、各占多少页、其中几页在内存
+    for (const auto& space : addressSpaces) {
+        std::map<std::string, std::pair<int, int>> files; // 文件名 -> (映射页数, 驻留页数)
+        for (const auto& pair : space.second.pageTable) {
+            if (!pair.second.fileBacked) continue;
+            auto& count = files[pair.second.file->name];
+            count.first++;
+            if (pair.second.present) count.second++;
+        }
+        for (const auto& f : files) {
+            std::cout << "  Mapped: " << f.first << " -> " << space.first << " | "
+                      << f.second.second << "/" << f.second.first << " page(s) resident\n";
+        }
+    }
+    if (forks > 0) {
+        std::cout << "  Fork/COW: forks " << forks << " | COW copies " << cowFaults
+                  << " | COW reuses " << cowReuses << "\n";
+    }
+
+    // 3. 各地址空间的预读统计
+    std::cout << "  Readahead (" << (readaheadEnabled ? "on" : "off") << "):\n";
+    bool anyReadahead = false;
+    for (const auto& pair : addressSpaces) {
+        const Readahead& ra = pair.second.readahead;
+        if (ra.getIssued() == 0) continue;
+        anyReadahead = true;
+        std::cout << std::fixed << std::setprecision(1)
+                  << "    | " << pair.first << ": issued " << ra.getIssued()
+                  << ", used " << ra.getUsed() << ", wasted " << ra.getWasted()
+                  << " | accuracy " << ra.accuracy() << "%, coverage " << ra.coverage() << "%"
+                  << " | window " << ra.getWindow() << "\n";
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6);
+    }
+    if (!anyReadahead) std::cout << "    (No prefetch issued)\n";
     std::cout << "=================================\n";
-}
\ No newline at end of file
+}
+
+// 碎片统计：外部碎片 = 1 - 最大空闲块 / 空闲总量；内部碎片 = 块内浪费 / 已分配块总量
+void MemoryManager::printFragmentation() const {
+    int allocatedTotal = 0;
+    int internalWaste = 0;
+
+    if (allocPolicy == ALLOC_BUDDY) {
+        allocatedTotal = buddy.getAllocatedBlockSize();
+        internalWaste = buddy.getInternalWaste();
+    } else {
+        for (const auto& pair : usedBlocks) allocatedTotal += pair.second.size;
+    }
+
+    double internal = allocatedTotal > 0 ? 100.0 * internalWaste / allocatedTotal : 0.0;
+
+    std::cout << "  Fragmentation: Free=" << getFreeTotal()
+              << " LargestFree=" << (allocPolicy == ALLOC_BUDDY ? buddy.getLargestFree() : freeIndex.getLargest())
+              << std::fixed << std::setprecision(1)
+              << " | External: " << getExternalFragmentation() << "%"
+              << " | Internal: " << internal << "% (" << internalWaste << " wasted)\n";
+    if (compactions > 0) {
+        std::cout << "  Compactions: " << compactions << " | Units moved: " << totalCompactedUnits
+                  << " | Time charged: " << totalCompactionTicks << " tick(s)\n";
+    }
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+}
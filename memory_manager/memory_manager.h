@@ -6,21 +6,112 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <memory>
 #include <cstdint>
 #include <iostream>
 #include <algorithm> // for sort
 #include <iomanip>   // for setw
+#include "buddy_allocator.h"
+#include "free_block_index.h"
+#include "slab_allocator.h"
+#include "readahead.h"
+#include "swap_device.h"
+#include "tlb.h"
+
+class StorageManager;
+
+// 连续分区的分配策略
+enum AllocPolicy {
+    ALLOC_FIRST_FIT,
+    ALLOC_NEXT_FIT,
+    ALLOC_BEST_FIT,
+    ALLOC_WORST_FIT,
+    ALLOC_BUDDY
+};
+
+// 一次紧凑的结果（碎片率为百分比）
+struct CompactionResult {
+    int movedBlocks = 0;
+    int movedUnits = 0;
+    int costTicks = 0;
+    double fragBefore = 0.0;
+    double fragAfter = 0.0;
+};
 
 class MemoryManager {
 public:
-    MemoryManager(int totalSize = 1024, int pageSize = 32, int maxFrames = 16); // maxFrames 默认改小一点方便演示，比如 4
+    MemoryManager(int totalSize = 1024, int pageSize = 32, int maxFrames = 16, // maxFrames 默认改小一点方便演示，比如 4
+                  const std::string& swapPath = ""); // 空：临时交换文件，退出时删除
 
     // 连续分区管理
     int* allocateMemory(int size);
-    void freeMemory(int* ptr);
+    // 固定分区（slab 等）和仍登记着句柄的分区属于别的模块，拒绝释放；所有者应先 untrackHandle
+    bool freeMemory(int* ptr);
+
+    // 切换分配策略（分区策略之间可随时切换；与伙伴系统互切需先释放所有分区）
+    bool setAllocPolicy(AllocPolicy policy);
+    AllocPolicy getAllocPolicy() const { return allocPolicy; }
+
+    // 固定分区：紧凑时不会被搬移（例如 slab）
+    void pinMemory(int* ptr);
 
-    // 虚拟存储管理：模拟访问页面
+    // 分区所有者登记自己的句柄，紧凑搬移分区后由内存管理器改写
+    void trackHandle(int** handle);
+    void untrackHandle(int** handle);
+
+    // 紧凑：把未固定的已用分区向低地址滑动，返回搬移量与模拟耗时
+    CompactionResult compact();
+    // 外部碎片率达到阈值 (%) 且分配失败时自动紧凑，<0 表示关闭
+    void setAutoCompaction(int thresholdPct) { autoCompactThreshold = thresholdPct; }
+    // 取出尚未计入调度器时间的紧凑开销（单位：tick）
+    int takeCompactionCost();
+    double getExternalFragmentation() const;
+    int getFreeTotal() const;
+
+    // 定长小对象的 slab 缓存（建立在分区分配之上）
+    SlabAllocator& getSlabAllocator() { return slabAllocator; }
+
+    // 虚拟存储管理：模拟访问页面（每个进程一个地址空间，不指定时使用内核地址空间）
     void accessPage(int page, bool write = false);
+    void accessPage(const std::string& owner, int page, bool write = false);
+    // 进程结束时回收其地址空间：释放物理帧与交换区中的页
+    void releaseAddressSpace(const std::string& owner);
+    // fork：子进程复制父进程页表，所有匿名页以写时复制方式共享，返回共享的页数
+    int forkAddressSpace(const std::string& parent, const std::string& child);
+    // 把磁盘文件映射到地址空间从 startPage 开始的连续页，返回映射的页数（失败返回 -1）
+    // 缺页时按文件的 blockIndices 从磁盘读入，脏页换出或解除映射时写回原块
+    int mapFile(const std::string& owner, int startPage, StorageManager& disk, const std::string& fileName);
+    bool unmapFile(const std::string& owner, const std::string& fileName);
+    int getMappedPages(const std::string& owner) const;
+    // 是否有页仍映射着该文件（path 为绝对路径）；映射按路径找文件，被映射的文件不能删除
+    bool isFileMapped(const std::string& path) const;
+    // 大页：每 factor 个对齐的基本页组成一个大页，0 表示关闭
+    // 访问频繁且全部驻留的区域自动提升为大页（一个 TLB 表项覆盖整个区域），内存紧张时再拆回基本页
+    void setHugePages(int factor);
+    int getHugePageFactor() const { return hugeFactor; }
+    // 顺序/跨步缺页预读开关
+    void setReadahead(bool enabled) { readaheadEnabled = enabled; }
+    long long getPageHits() const { return pageHits; }
+    long long getPageFaults() const { return pageFaults; }
+
+    // 共享内存段（shmget/shmat 风格）：段的每一页至多占一个物理帧，所有挂接的进程页表都映射到同一帧，
+    // 进程间交换数据只需建立映射，不按字节复制。最后一个映射者离开时页内容保存到交换区，
+    // 段被删除 (shmrm) 后在最后一个进程分离时才真正释放
+    static constexpr int MAX_SEGMENT_PAGES = 65536; // 单个段的页数上限，段的每页都有帧号与交换槽位两个表项
+    bool createSegment(const std::string& name, int pages);
+    // 挂接到地址空间从 startPage 开始的连续页，返回页数（失败返回 -1）；只建立页表项，缺页时才映射帧
+    int attachSegment(const std::string& owner, const std::string& name, int startPage);
+    bool detachSegment(const std::string& owner, const std::string& name);
+    bool removeSegment(const std::string& name);
+    // 以 owner 的身份经其页表读写段内数据（模拟进程直接访问共享内存），返回读写的字节数，失败返回 -1
+    int writeSegment(const std::string& owner, const std::string& name, int offset, const std::string& data);
+    int readSegment(const std::string& owner, const std::string& name, int offset, int len, std::string& out);
+    void printSegments() const;
+
+    static const std::string KERNEL_SPACE;
 
     // 【新增】打印内存状态（分区情况 + 分页情况）
     void printStatus() const;
@@ -29,29 +120,145 @@ private:
     struct Block {
         int start;
         int size;
+        bool pinned;
+    };
+
+    struct FileMapping {
+        StorageManager* disk;
+        std::string name;
+    };
+
+    struct ShmSegment {
+        std::string name;
+        int pages = 0;
+        std::vector<int> frame;    // 每页驻留的帧，-1 表示不在内存
+        std::vector<int> swapSlot; // 每页在交换区中的有效副本，-1 表示没有
+        std::map<std::string, int> attached; // 地址空间 -> 起始页
+        bool removed = false;      // 已标记删除，最后一个进程分离时释放
+        long long attaches = 0;
+        long long detaches = 0;
+        long long majorFaults = 0; // 缺页时从交换区读入或清零
+        long long sharedFaults = 0; // 缺页时帧已被其他进程调入，直接映射
+        long long bytesWritten = 0;
+        long long bytesRead = 0;
     };
 
     struct PageTableEntry {
-        int frame;
-        bool present;
-        bool inSwap;
-        bool fileBacked;
-        bool dirty;
+        int frame = -1;
+        bool present = false;
+        bool inSwap = false;
+        bool fileBacked = false;
+        bool cow = false;    // 写保护的共享页，写入时触发复制
+        int swapSlot = -1;   // 在交换区中的槽位，-1 表示没有
+        std::shared_ptr<const FileMapping> file; // 文件映射页：所属文件（fork 后父子共享）
+        int fileOffset = 0;  // 本页在文件内的字节偏移
+        bool huge = false;   // 属于一个大页
+        ShmSegment* shm = nullptr; // 共享内存页：所属段（交换副本由段保存，不记在页表项里）
+        int shmPage = 0;
+    };
+
+    using Mapping = std::pair<std::string, int>; // (地址空间, 页号)
+
+    // 物理帧：mappers 为反向映射，记录所有映射到该帧的页（写时复制共享时有多个）
+    struct Frame {
+        std::vector<Mapping> mappers;
+        int swapSlot = -1;       // 交换区中仍有效的副本（干净页换出时无需再写）
+        bool dirty = false;
+        bool prefetched = false; // 预读调入、尚未被访问过
+        bool huge = false;       // 属于某个大页的对齐帧组
+        ShmSegment* shm = nullptr; // 共享内存段的页
+        int shmPage = -1;
+    };
+
+    struct AddressSpace {
+        std::unordered_map<int, PageTableEntry> pageTable;
+        Readahead readahead;
+        std::unordered_map<int, int> regionHeat; // 大页区域号 -> 访问次数（提升候选）
+        std::set<int> hugeRegions;               // 已提升为大页的区域号
     };
 
-    std::vector<Block> freeList;
     std::unordered_map<int, Block> usedBlocks;
-    std::unordered_map<int, PageTableEntry> pageTable;
-    std::list<int> lruList; // 模拟物理内存帧的 LRU 队列
-    std::unordered_set<int> swapArea;
-    std::unordered_set<int> fileArea;
+    std::map<std::string, AddressSpace> addressSpaces;
+    std::vector<Frame> frames;
+    std::vector<int> freeFrames;
+    std::list<int> lruList; // 物理帧号的 LRU 队列，队头为最近使用
+    std::unordered_map<int, std::list<int>::iterator> lruPos;
+    std::vector<char> physicalMemory; // 物理帧的真实内容，maxFrames * pageSize 字节
 
     int totalSize;
     int pageSize;
     int maxFrames;
 
-    void swapIn(int page);
-    void swapOut(int page);
+    AllocPolicy allocPolicy = ALLOC_FIRST_FIT;
+    FreeBlockIndex freeIndex; // 分区策略使用的空闲块索引
+    BuddyAllocator buddy;
+    SlabAllocator slabAllocator;
+    SwapDevice swapDevice;
+    int nextFitCursor = 1; // 循环首次适应的游标
+
+    // 紧凑
+    static constexpr int COPY_UNITS_PER_TICK = 64; // 搬移开销模型：每 tick 拷贝的单元数
+    std::vector<int**> handles;
+    int autoCompactThreshold = -1;
+    int pendingCompactionTicks = 0;
+    int compactions = 0;
+    int totalCompactedUnits = 0;
+    int totalCompactionTicks = 0;
+
+    int findFreeBlock(int size) const;
+
+    // 分页
+    static constexpr int HUGE_PROMOTE_HEAT = 2; // 区域内平均每页被访问这么多次才提升
+    Tlb tlb;
+    int hugeFactor = 0;
+    long long promotions = 0;
+    long long demotions = 0;
+    long long promoteCopies = 0; // 提升时为凑齐对齐帧组而搬移的帧数
+    bool readaheadEnabled = true;
+    long long pageHits = 0;
+    long long pageFaults = 0;
+    long long forks = 0;
+    long long cowFaults = 0;   // 写时复制：真正复制了物理帧
+    long long cowReuses = 0;   // 写时复制：帧已独占，只解除写保护
+    unsigned int writeSeq = 0; // 写访问时盖到页内的序号，模拟页内容变化
+
+    AddressSpace& getAddressSpace(const std::string& owner);
+    PageTableEntry& getPte(AddressSpace& as, int page);
+    void touchFrame(int frame);
+    void touchPage(const AddressSpace& as, const PageTableEntry& pte, int page);
+    long long tlbKey(const PageTableEntry& pte, int page) const {
+        return pte.huge ? -(page / hugeFactor) - 1 : page; // 大页表项用负数编号，与基本页区分
+    }
+    void tryPromote(const std::string& owner, AddressSpace& as, int page);
+    void demote(const std::string& owner, AddressSpace& as, int region, const char* reason);
+    void exchangeFrames(int a, int b);
+    int allocFrame();
+    void unmapFrame(int frame, const Mapping& m);
+    void breakCow(const std::string& owner, PageTableEntry& pte, int page);
+    char* frameData(int frame) { return physicalMemory.data() + static_cast<size_t>(frame) * pageSize; }
+    void readahead(const std::string& owner, AddressSpace& as, int page);
+    void readFilePage(const PageTableEntry& pte, char* out);
+    void writeFilePage(const PageTableEntry& pte, const char* data);
+    void dropPage(const std::string& owner, int page, const PageTableEntry& pte);
+
+    // 共享内存（std::map 的节点地址不变，页表项与帧可以直接指向段）
+    std::map<std::string, ShmSegment> segments;
+    // 共享页缺页：段页已在内存（被其他进程调入）则直接映射，否则从交换区调入或清零
+    void faultShared(const std::string& owner, int page, PageTableEntry& pte, bool prefetch);
+    // 段页被改写，交换区里的旧副本作废
+    void dirtyShared(Frame& f);
+    // 段页离开内存：脏页或没有副本时写到交换区（段已删除且无人挂接时直接丢弃）
+    void saveSharedPage(int frame);
+    void destroySegment(const std::string& name);
+    // 从 owner 的地址空间去掉段的映射
+    void unmapSegment(const std::string& owner, ShmSegment& seg, int startPage);
+    // 经页表拿到段内第 index 页的数据（缺页时调入）
+    char* segmentPage(const std::string& owner, const ShmSegment& seg, int startPage, int index, bool write);
+    long long segmentBytes(const ShmSegment& seg) const { return static_cast<long long>(seg.pages) * pageSize; }
+
+    void printFragmentation() const;
+    void swapIn(const std::string& owner, int page, bool prefetch = false);
+    void swapOut(int frame);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,52 @@
+#include "readahead.h"
+#include <cstdlib>
+#include <algorithm>
+
+Readahead::Readahead(int maxWindow)
+    : maxWindow(maxWindow > 0 ? maxWindow : 1) {}
+
+std::vector<int> Readahead::onAccess(int page) {
+    std::vector<int> pages;
+
+    // 1. 模式识别：步长是否与上一次一致
+    if (hasLast) {
+        int delta = page - lastPage;
+        if (delta != 0 && delta == stride) {
+            streak++;
+        } else {
+            stride = (delta != 0 && std::abs(delta) <= MAX_STRIDE) ? delta : 0;
+            streak = stride != 0 ? 1 : 0;
+            window = 0; // 模式被打断，退出流式模式
+        }
+    }
+    hasLast = true;
+    lastPage = page;
+
+    // 2. 至少两步相同步长才开始预读
+    if (stride == 0 || streak < 2) return pages;
+
+    if (window == 0) {
+        window = std::min(MIN_WINDOW, maxWindow);
+        prefetchedUpTo = page;
+    }
+
+    // 3. 从已预取的最远处继续，保证窗口始终领先当前访问 window 页
+    int target = page + stride * window;
+    int next = (prefetchedUpTo - page) * stride > 0 ? prefetchedUpTo + stride : page + stride;
+    for (; (target - next) * stride >= 0; next += stride) {
+        if (next < 0) break;
+        pages.push_back(next);
+    }
+    if (!pages.empty()) prefetchedUpTo = pages.back();
+    return pages;
+}
+
+void Readahead::onPrefetchUsed() {
+    used++;
+    if (window > 0) window = std::min(window * 2, maxWindow);
+}
+
+void Readahead::onPrefetchWasted() {
+    wasted++;
+    if (window > 1) window /= 2;
+}
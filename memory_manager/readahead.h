@@ -0,0 +1,52 @@
+// memory_manager/readahead.h
+#ifndef READAHEAD_H
+#define READAHEAD_H
+
+#include <vector>
+
+// 每个地址空间一份的预读状态机
+// 连续两步缺页的步长相同（顺序扫描 stride=1，或跨步扫描）即认定为流式访问，
+// 随后沿步长方向预取一个窗口的页面。预取页被命中则窗口翻倍，未用即被淘汰则窗口减半。
+class Readahead {
+public:
+    explicit Readahead(int maxWindow = 8);
+
+    // 缺页或首次命中预取页时调用，返回需要预取的页号
+    std::vector<int> onAccess(int page);
+    void onDemandFault() { demandFaults++; }
+    void onPrefetchIssued() { issued++; }
+    void onPrefetchUsed();
+    void onPrefetchWasted();
+    void setMaxWindow(int w) { maxWindow = w > 0 ? w : 1; }
+
+    int getWindow() const { return window; }
+    int getStride() const { return stride; }
+    long long getIssued() const { return issued; }
+    long long getUsed() const { return used; }
+    long long getWasted() const { return wasted; }
+    long long getDemandFaults() const { return demandFaults; }
+    // 准确率 = 被用到的预取 / 发出的预取；覆盖率 = 被预取消除的缺页 / (其 + 剩余缺页)
+    double accuracy() const { return issued > 0 ? 100.0 * used / issued : 0.0; }
+    double coverage() const {
+        return (used + demandFaults) > 0 ? 100.0 * used / (used + demandFaults) : 0.0;
+    }
+
+private:
+    static constexpr int MAX_STRIDE = 16; // 超过此跨度视为随机访问
+    static constexpr int MIN_WINDOW = 2;
+
+    int maxWindow;
+    bool hasLast = false;
+    int lastPage = 0;
+    int stride = 0;
+    int streak = 0;          // 连续相同步长的次数
+    int window = 0;          // 当前预读窗口（页数），0 表示未进入流式模式
+    int prefetchedUpTo = 0;  // 已经预取到的最远页（沿步长方向）
+
+    long long issued = 0;
+    long long used = 0;
+    long long wasted = 0;
+    long long demandFaults = 0;
+};
+
+#endif
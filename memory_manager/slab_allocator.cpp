@@ -0,0 +1,188 @@
+#include "slab_allocator.h"
+#include "memory_manager.h"
+#include <iostream>
+#include <iomanip>
+#include <cstdint>
+#include <algorithm>
+
+SlabAllocator::SlabAllocator(MemoryManager& mm, int numCpus)
+    : mm(mm),
+      numCpus(numCpus > 0 ? numCpus : 1) {}
+
+bool SlabAllocator::createCache(const std::string& name, int objSize, int objsPerSlab) {
+    if (objSize <= 0 || objsPerSlab <= 0) {
+        std::cout << "[Slab] Error: Invalid object size.\n";
+        return false;
+    }
+    if (caches.count(name)) {
+        std::cout << "[Slab] Error: Cache '" << name << "' already exists.\n";
+        return false;
+    }
+
+    Cache cache;
+    cache.name = name;
+    cache.objSize = objSize;
+    cache.objsPerSlab = objsPerSlab;
+    // 着色数：对象大小能错开几个对齐步长就轮转几种颜色
+    cache.colors = std::max(1, std::min(objSize / COLOR_ALIGN, 4));
+    cache.magazines.resize(static_cast<size_t>(numCpus));
+    caches.emplace(name, std::move(cache));
+
+    std::cout << "[Slab] Cache '" << name << "' created (obj=" << objSize
+              << ", " << objsPerSlab << " objs/slab).\n";
+    return true;
+}
+
+/* ================= slab 增长 ================= */
+
+bool SlabAllocator::grow(Cache& cache) {
+    // 分区大小 = 对象区 + 最大着色偏移，保证每种颜色都放得下
+    int color = cache.nextColor * COLOR_ALIGN;
+    int size = cache.objSize * cache.objsPerSlab + (cache.colors - 1) * COLOR_ALIGN;
+
+    int* ptr = mm.allocateMemory(size);
+    if (ptr == nullptr) return false;
+    mm.pinMemory(ptr); // 对象地址已交给使用者，slab 分区不能被紧凑搬移
+    int base = static_cast<int>(reinterpret_cast<intptr_t>(ptr));
+
+    cache.nextColor = (cache.nextColor + 1) % cache.colors;
+
+    int slabIdx = static_cast<int>(cache.slabs.size());
+    Slab slab{base, color, size, {}};
+    // 倒序压栈，使低地址对象先被分配
+    for (int i = cache.objsPerSlab - 1; i >= 0; --i) {
+        int addr = base + color + i * cache.objSize;
+        slab.freeObjs.push_back(addr);
+        cache.objects[addr] = ObjInfo{slabIdx, false};
+    }
+    cache.slabs.push_back(std::move(slab));
+    cache.partialSlabs.push_back(slabIdx);
+
+    std::cout << "[Slab] Cache '" << cache.name << "' grew: slab #" << slabIdx
+              << " at " << base << " (color +" << color << ").\n";
+    return true;
+}
+
+/* ================= 对象分配与释放 ================= */
+
+int SlabAllocator::takeFromSlab(Cache& cache) {
+    if (cache.partialSlabs.empty() && !grow(cache)) return -1;
+
+    Slab& slab = cache.slabs[cache.partialSlabs.back()];
+    int addr = slab.freeObjs.back();
+    slab.freeObjs.pop_back();
+    if (slab.freeObjs.empty()) cache.partialSlabs.pop_back(); // 满 slab 移出 partial 栈
+    return addr;
+}
+
+void SlabAllocator::returnToSlab(Cache& cache, int addr) {
+    int slabIdx = cache.objects[addr].slab;
+    Slab& slab = cache.slabs[slabIdx];
+    if (slab.freeObjs.empty()) cache.partialSlabs.push_back(slabIdx); // 由满变为部分空闲
+    slab.freeObjs.push_back(addr);
+}
+
+int SlabAllocator::alloc(const std::string& name, int cpu) {
+    if (cpu < 0 || cpu >= numCpus) {
+        std::cout << "[Slab] Error: CPU " << cpu << " out of range (0-" << numCpus - 1 << ").\n";
+        return -1;
+    }
+    auto it = caches.find(name);
+    if (it == caches.end()) {
+        std::cout << "[Slab] Error: Cache '" << name << "' not found.\n";
+        return -1;
+    }
+    Cache& cache = it->second;
+    std::vector<int>& mag = cache.magazines[static_cast<size_t>(cpu)];
+
+    int addr;
+    if (!mag.empty()) {
+        addr = mag.back();
+        mag.pop_back();
+        cache.magazineHits++;
+    } else {
+        addr = takeFromSlab(cache);
+        if (addr < 0) {
+            std::cout << "[Slab] Error: Out of memory for cache '" << name << "'.\n";
+            return -1;
+        }
+    }
+
+    cache.objects[addr].live = true;
+    cache.inUse++;
+    cache.allocs++;
+    std::cout << "[Slab] Alloc '" << name << "' object at " << addr << " (CPU " << cpu << ").\n";
+    return addr;
+}
+
+bool SlabAllocator::free(const std::string& name, int addr, int cpu) {
+    if (cpu < 0 || cpu >= numCpus) {
+        std::cout << "[Slab] Error: CPU " << cpu << " out of range (0-" << numCpus - 1 << ").\n";
+        return false;
+    }
+    auto it = caches.find(name);
+    if (it == caches.end()) return false;
+    Cache& cache = it->second;
+
+    auto obj = cache.objects.find(addr);
+    if (obj == cache.objects.end() || !obj->second.live) {
+        std::cout << "[Slab] Error: " << addr << " is not a live '" << name << "' object.\n";
+        return false;
+    }
+    obj->second.live = false;
+    cache.inUse--;
+    cache.frees++;
+
+    // magazine 满了就把一半对象还给 slab，避免对象长期滞留在某个 CPU
+    std::vector<int>& mag = cache.magazines[static_cast<size_t>(cpu)];
+    if (static_cast<int>(mag.size()) >= MAG_ROUNDS) {
+        for (int i = 0; i < MAG_ROUNDS / 2; ++i) {
+            returnToSlab(cache, mag.back());
+            mag.pop_back();
+        }
+    }
+    mag.push_back(addr);
+
+    std::cout << "[Slab] Free '" << name << "' object at " << addr << ".\n";
+    return true;
+}
+
+/* ================= 统计 ================= */
+
+void SlabAllocator::printStatus() const {
+    std::cout << "\n[Slab Caches]\n";
+    if (caches.empty()) {
+        std::cout << "  (None)\n";
+        return;
+    }
+    std::cout << "  " << std::left << std::setw(12) << "Cache"
+              << std::setw(6) << "Obj"
+              << std::setw(7) << "Slabs"
+              << std::setw(10) << "InUse"
+              << std::setw(8) << "Cached"
+              << std::setw(8) << "Waste"
+              << "MagHit" << std::right << "\n";
+
+    for (const auto& pair : caches) {
+        const Cache& c = pair.second;
+        int total = static_cast<int>(c.slabs.size()) * c.objsPerSlab;
+        int cached = 0;
+        for (const auto& mag : c.magazines) cached += static_cast<int>(mag.size());
+        // 浪费 = slab 分区中不能放对象的着色空隙 + 未被使用的对象空间
+        int waste = 0;
+        for (const auto& s : c.slabs) waste += s.size - c.objsPerSlab * c.objSize;
+        waste += (total - c.inUse) * c.objSize;
+        double hitRate = c.allocs > 0 ? 100.0 * c.magazineHits / c.allocs : 0.0;
+
+        std::cout << "  " << std::left << std::setw(12) << c.name
+                  << std::setw(6) << c.objSize
+                  << std::setw(7) << c.slabs.size()
+                  << std::setw(10) << (std::to_string(c.inUse) + "/" + std::to_string(total))
+                  << std::setw(8) << cached
+                  << std::setw(8) << waste
+                  << std::fixed << std::setprecision(1) << hitRate << "%"
+                  << std::right << "\n";
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6);
+    }
+}
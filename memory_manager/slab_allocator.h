@@ -0,0 +1,72 @@
+// memory_manager/slab_allocator.h
+#ifndef SLAB_ALLOCATOR_H
+#define SLAB_ALLOCATOR_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+
+class MemoryManager;
+
+// Slab 对象缓存：为 PCB、消息、文件节点等定长小对象服务
+//  - 每个 cache 从 MemoryManager::allocateMemory 申请分区作为 slab，再切成等长对象
+//  - slab 起始偏移按 "着色" 轮转，错开不同 slab 中对象的缓存行
+//  - 每个 CPU 有一个 magazine（对象地址栈），分配/释放优先命中 magazine，均为 O(1)
+class SlabAllocator {
+public:
+    explicit SlabAllocator(MemoryManager& mm, int numCpus = 2);
+
+    bool createCache(const std::string& name, int objSize, int objsPerSlab = 8);
+    // 返回对象地址，失败返回 -1；cpu 必须在 [0, getCpuCount()) 内
+    int alloc(const std::string& name, int cpu = 0);
+    bool free(const std::string& name, int addr, int cpu = 0);
+
+    int getCpuCount() const { return numCpus; }
+
+    void printStatus() const;
+
+private:
+    static constexpr int COLOR_ALIGN = 4;   // 着色步长
+    static constexpr int MAG_ROUNDS = 4;    // 每个 magazine 容纳的对象数
+
+    struct Slab {
+        int base;                   // 分区起始地址
+        int color;                  // 本 slab 的着色偏移
+        int size;                   // 分区大小
+        std::vector<int> freeObjs;  // 空闲对象地址栈
+    };
+
+    struct ObjInfo {
+        int slab;
+        bool live; // 是否已交给使用者
+    };
+
+    struct Cache {
+        std::string name;
+        int objSize = 0;
+        int objsPerSlab = 0;
+        int colors = 1;
+        int nextColor = 0;
+
+        std::vector<Slab> slabs;
+        std::vector<int> partialSlabs;               // 仍有空闲对象的 slab 下标
+        std::vector<std::vector<int>> magazines;     // 每 CPU 一个
+        std::unordered_map<int, ObjInfo> objects;    // 对象地址 -> 所属 slab
+
+        int inUse = 0;
+        long long allocs = 0;
+        long long frees = 0;
+        long long magazineHits = 0;
+    };
+
+    bool grow(Cache& cache);
+    int takeFromSlab(Cache& cache);
+    void returnToSlab(Cache& cache, int addr);
+
+    MemoryManager& mm;
+    int numCpus;
+    std::map<std::string, Cache> caches;
+};
+
+#endif
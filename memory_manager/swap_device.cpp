@@ -0,0 +1,209 @@
+#include "swap_device.h"
+#include <iostream>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cstdlib>
+#include <unistd.h>
+#endif
+
+SwapDevice::SwapDevice(const std::string& path, int pageSize)
+    : path(path),
+      pageSize(pageSize) {
+    // 每次启动都重新创建交换文件，交换区内容不跨运行保留
+    if (path.empty()) openTemporary();
+    else file.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cout << "[Swap] Warning: cannot open swap file '" << path << "'.\n";
+    }
+    flusher = std::thread(&SwapDevice::flusherLoop, this);
+}
+
+SwapDevice::~SwapDevice() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cv.notify_all();
+    flusher.join();
+    file.close();
+#ifdef _WIN32
+    if (temporary) std::remove(path.c_str());
+#endif
+}
+
+#ifdef _WIN32
+
+bool SwapDevice::openTemporary() {
+    char dir[MAX_PATH];
+    char name[MAX_PATH];
+    if (GetTempPathA(MAX_PATH, dir) == 0 || GetTempFileNameA(dir, "osw", 0, name) == 0) return false;
+    path = name;
+    temporary = true;
+    file.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    return file.is_open();
+}
+
+#else
+
+bool SwapDevice::openTemporary() {
+    const char* tmp = std::getenv("TMPDIR");
+    std::string name = std::string(tmp && *tmp ? tmp : "/tmp") + "/os_swap.XXXXXX";
+    int fd = mkstemp(&name[0]);
+    if (fd < 0) return false;
+    path = name;
+    temporary = true;
+    file.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    ::close(fd);
+    ::unlink(path.c_str()); // 已打开的文件在关闭前仍可读写
+    return file.is_open();
+}
+
+#endif
+
+/* ================= 槽位分配 ================= */
+
+int SwapDevice::allocSlot() {
+    int slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = static_cast<int>(slotRefs.size());
+        slotRefs.push_back(0);
+    }
+    slotRefs[slot] = 1;
+    slotsInUse++;
+    return slot;
+}
+
+void SwapDevice::addRef(int slot) {
+    if (slot >= 0) slotRefs[slot]++;
+}
+
+void SwapDevice::release(int slot) {
+    if (slot < 0 || slotRefs[slot] <= 0) return;
+    if (--slotRefs[slot] > 0) return;
+
+    freeSlots.push_back(slot);
+    slotsInUse--;
+    // 槽位已作废，还没落盘的写可以直接丢弃
+    std::lock_guard<std::mutex> lock(mtx);
+    if (pending.erase(slot) != 0U) writesCancelled++;
+}
+
+int SwapDevice::refCount(int slot) const {
+    return slot >= 0 && slot < static_cast<int>(slotRefs.size()) ? slotRefs[slot] : 0;
+}
+
+/* ================= 页内容读写 ================= */
+
+void SwapDevice::writeAsync(int slot, const char* data) {
+    size_t queued;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        pending[slot].assign(data, data + pageSize);
+        queued = pending.size();
+    }
+    if (queued >= BATCH_PAGES) cv.notify_one();
+}
+
+void SwapDevice::read(int slot, char* out) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        pagesRead++;
+
+        // 1. 还在待写或正在刷写的缓冲里：直接拷贝，不读文件
+        auto it = pending.find(slot);
+        bool buffered = it != pending.end();
+        if (!buffered) {
+            it = inflight.find(slot);
+            buffered = it != inflight.end();
+        }
+        if (buffered) {
+            std::memcpy(out, it->second.data(), static_cast<size_t>(pageSize));
+            readsFromBuffer++;
+            return;
+        }
+    }
+
+    // 2. 从交换文件读出
+    std::lock_guard<std::mutex> fileLock(fileMtx);
+    std::memset(out, 0, static_cast<size_t>(pageSize));
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(slot) * pageSize);
+    file.read(out, pageSize);
+    file.clear(); // 文件尾部以外的读视为全零页
+}
+
+void SwapDevice::sync() {
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.notify_one();
+    drained.wait(lock, [this] { return pending.empty() && inflight.empty(); });
+}
+
+/* ================= 后台刷写线程 ================= */
+
+void SwapDevice::flusherLoop() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        cv.wait_for(lock, std::chrono::milliseconds(FLUSH_INTERVAL_MS),
+                    [this] { return stopping || pending.size() >= BATCH_PAGES; });
+
+        if (!pending.empty()) {
+            inflight.swap(pending);
+            lock.unlock();
+            int written = writeBatch(inflight);
+            lock.lock();
+
+            pagesWritten += static_cast<long long>(inflight.size());
+            clusters += written;
+            batches++;
+            inflight.clear();
+        }
+        if (pending.empty()) drained.notify_all();
+        if (stopping && pending.empty()) break;
+    }
+}
+
+// batch 按槽位有序，相邻槽位合并成一次 seek + write，返回写入的簇数
+int SwapDevice::writeBatch(const std::map<int, std::vector<char>>& batch) {
+    std::lock_guard<std::mutex> fileLock(fileMtx);
+    int written = 0;
+    std::vector<char> cluster;
+    int clusterStart = -1;
+    int prevSlot = -2;
+
+    auto flushCluster = [&]() {
+        if (cluster.empty()) return;
+        file.clear();
+        file.seekp(static_cast<std::streamoff>(clusterStart) * pageSize);
+        file.write(cluster.data(), static_cast<std::streamsize>(cluster.size()));
+        written++;
+        cluster.clear();
+    };
+
+    for (const auto& pair : batch) {
+        if (pair.first != prevSlot + 1) {
+            flushCluster();
+            clusterStart = pair.first;
+        }
+        cluster.insert(cluster.end(), pair.second.begin(), pair.second.end());
+        prevSlot = pair.first;
+    }
+    flushCluster();
+    file.flush();
+    return written;
+}
+
+void SwapDevice::printStatus() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    std::cout << "  Swap Device: " << path << (temporary ? " (temporary)" : "") << " | Slots in use: " << slotsInUse
+              << "/" << slotRefs.size() << " | Pending write-back: " << pending.size() << "\n";
+    std::cout << "    | Written: " << pagesWritten << " page(s) in " << batches << " batch(es), "
+              << clusters << " cluster(s) | Read: " << pagesRead
+              << " (" << readsFromBuffer << " from buffer) | Cancelled: " << writesCancelled << "\n";
+}
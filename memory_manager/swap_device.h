@@ -0,0 +1,78 @@
+// memory_manager/swap_device.h
+#ifndef SWAP_DEVICE_H
+#define SWAP_DEVICE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// 交换设备：宿主机上的一个真实交换文件，按页大小划分槽位
+//  - 槽位分配器：空闲槽位栈 + 引用计数（fork 后多个页表可共享同一槽位）
+//  - 写出是异步的：换出只把页内容放进待写缓冲，后台刷写线程按槽位排序、
+//    把相邻槽位合并成一次写，批量落盘，模拟循环不会因换出而等待 IO
+//  - path 为空时在系统临时目录建一个唯一的交换文件，退出时删除，同目录下并发的多次运行互不干扰
+class SwapDevice {
+public:
+    SwapDevice(const std::string& path, int pageSize);
+    ~SwapDevice();
+
+    SwapDevice(const SwapDevice&) = delete;
+    SwapDevice& operator=(const SwapDevice&) = delete;
+
+    // 槽位管理（分配出的槽位引用计数为 1）
+    int allocSlot();
+    void addRef(int slot);
+    void release(int slot);
+    int refCount(int slot) const;
+
+    // 页内容读写；写入异步完成，读取会先查待写缓冲保证一致
+    void writeAsync(int slot, const char* data);
+    void read(int slot, char* out);
+    // 等待所有待写页落盘
+    void sync();
+
+    void printStatus() const;
+
+private:
+    static constexpr size_t BATCH_PAGES = 8;   // 攒够这么多页就唤醒刷写线程
+    static constexpr int FLUSH_INTERVAL_MS = 50;
+
+    // 创建并打开唯一的临时交换文件（POSIX 上打开后立即 unlink，异常退出也不会留下文件）
+    bool openTemporary();
+    void flusherLoop();
+    int writeBatch(const std::map<int, std::vector<char>>& batch);
+
+    std::string path;
+    int pageSize;
+    std::fstream file;
+    bool temporary = false;
+
+    // 槽位分配（只在模拟线程中访问）
+    std::vector<int> slotRefs;
+    std::vector<int> freeSlots;
+    int slotsInUse = 0;
+
+    // 待写缓冲（与刷写线程共享）；文件读写另用一把锁，刷写落盘时不阻塞换出
+    mutable std::mutex mtx;
+    std::mutex fileMtx;
+    std::condition_variable cv;
+    std::condition_variable drained;
+    std::map<int, std::vector<char>> pending;   // 等待刷写
+    std::map<int, std::vector<char>> inflight;  // 正在被刷写
+    bool stopping = false;
+    std::thread flusher;
+
+    // 统计
+    long long pagesWritten = 0;
+    long long batches = 0;
+    long long clusters = 0;
+    long long pagesRead = 0;
+    long long readsFromBuffer = 0;
+    long long writesCancelled = 0;
+};
+
+#endif
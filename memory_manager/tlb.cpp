@@ -0,0 +1,55 @@
+#include "tlb.h"
+
+Tlb::Tlb(int capacity)
+    : capacity(capacity > 0 ? capacity : 1) {}
+
+bool Tlb::lookup(const std::string& owner, long long key) {
+    auto it = index.find({owner, key});
+    if (it == index.end()) {
+        misses++;
+        return false;
+    }
+    entries.splice(entries.begin(), entries, it->second);
+    hits++;
+    return true;
+}
+
+void Tlb::insert(const std::string& owner, long long key, int span) {
+    Key k{owner, key};
+    auto it = index.find(k);
+    if (it != index.end()) {
+        it->second->span = span;
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+    if (static_cast<int>(entries.size()) >= capacity) {
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+    entries.push_front(Entry{k, span});
+    index[k] = entries.begin();
+}
+
+void Tlb::invalidate(const std::string& owner, long long key) {
+    auto it = index.find({owner, key});
+    if (it == index.end()) return;
+    entries.erase(it->second);
+    index.erase(it);
+}
+
+void Tlb::flush(const std::string& owner) {
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (it->key.first == owner) {
+            index.erase(it->key);
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+int Tlb::reachPages() const {
+    int pages = 0;
+    for (const Entry& e : entries) pages += e.span;
+    return pages;
+}
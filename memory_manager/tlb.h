@@ -0,0 +1,47 @@
+// memory_manager/tlb.h
+#ifndef TLB_H
+#define TLB_H
+
+#include <string>
+#include <list>
+#include <map>
+#include <utility>
+
+// 全相联、LRU 替换的快表模型
+// 每个表项缓存一次地址翻译：普通页覆盖 1 页，大页覆盖 span 页，
+// 因此同样的表项数下大页能覆盖（reach）更大的地址范围。
+class Tlb {
+public:
+    explicit Tlb(int capacity = 8);
+
+    // 查找 (地址空间, 虚拟页号/大页号) 的翻译，命中时移到队头
+    bool lookup(const std::string& owner, long long key);
+    // 插入一条翻译，span 为该表项覆盖的页数；已满时淘汰最久未用的表项
+    void insert(const std::string& owner, long long key, int span);
+    void invalidate(const std::string& owner, long long key);
+    void flush(const std::string& owner);
+
+    int getCapacity() const { return capacity; }
+    int size() const { return static_cast<int>(entries.size()); }
+    // 当前所有表项覆盖的页数
+    int reachPages() const;
+    long long getHits() const { return hits; }
+    long long getMisses() const { return misses; }
+    double hitRate() const { return (hits + misses) > 0 ? 100.0 * hits / (hits + misses) : 0.0; }
+
+private:
+    using Key = std::pair<std::string, long long>;
+    struct Entry {
+        Key key;
+        int span;
+    };
+
+    int capacity;
+    std::list<Entry> entries; // 队头为最近使用
+    std::map<Key, std::list<Entry>::iterator> index;
+
+    long long hits = 0;
+    long long misses = 0;
+};
+
+#endif
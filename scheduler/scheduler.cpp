@@ -59,6 +59,25 @@ void Scheduler::createThread(const std::string& pid) {
     std::cout << "[System] Thread created for process " << pid << "\n";
 }
 
+PCB* Scheduler::forkProcess(const std::string& parentPid, const std::string& childPid) {
+    PCB* parent = getProcess(parentPid);
+    if (!parent || parent->state == FINISHED) {
+        std::cout << "[Error] Process " << parentPid << " not found or finished.\n";
+        return nullptr;
+    }
+    if (getProcess(childPid)) {
+        std::cout << "[Error] Process " << childPid << " already exists.\n";
+        return nullptr;
+    }
+
+    createProcess(childPid, globalTime, parent->remainingTime, parent->memSize);
+    PCB* child = getProcess(childPid);
+    child->threads = parent->threads;
+    child->priority = parent->priority;
+    child->effectivePriority = parent->priority;
+    return child;
+}
+
 /* ================= 调度核心 ================= */
 
 void Scheduler::checkArrivals() {
@@ -76,6 +95,16 @@ void Scheduler::checkArrivals() {
     }
 }
 
+PCB* Scheduler::takeNextReady() {
+    auto best = readyQueue.begin();
+    for (auto it = readyQueue.begin(); it != readyQueue.end(); ++it) {
+        if ((*it)->effectivePriority > (*best)->effectivePriority) best = it;
+    }
+    PCB* p = *best;
+    readyQueue.erase(best);
+    return p;
+}
+
 void Scheduler::tick() {
     checkArrivals();
 
@@ -86,13 +115,32 @@ void Scheduler::tick() {
     globalTime++;
 }
 
+void Scheduler::chargeOverhead(int ticks, const std::string& reason) {
+    if (ticks <= 0) return;
+    globalTime += ticks;
+    overheadTime += ticks;
+    std::cout << "[Time " << globalTime << "] System overhead: " << reason
+              << " took " << ticks << " tick(s)\n";
+}
+
+int Scheduler::idle(int ticks) {
+    if (ticks <= 0 || runningProcess || !readyQueue.empty()) return 0;
+    // 不能越过下一个进程的到达时间
+    if (nextArrivalIdx < static_cast<int>(allProcesses.size())) {
+        ticks = std::min(ticks, std::max(0, allProcesses[nextArrivalIdx]->arrivalTime - globalTime));
+    }
+    if (ticks <= 0) return 0;
+    globalTime += ticks;
+    std::cout << "[Time " << globalTime << "] CPU idle for " << ticks << " tick(s)\n";
+    return ticks;
+}
+
 /* ================== FCFS ================== */
 
 void Scheduler::tickFCFS() {
     // 1. 尝试调度：如果你没在跑，且队里有人，就选一个
     if (!runningProcess && !readyQueue.empty()) {
-        runningProcess = readyQueue.front();
-        readyQueue.pop_front();
+        runningProcess = takeNextReady();
         runningProcess->state = RUNNING;
 
         if (runningProcess->startTime == -1)
@@ -105,6 +153,7 @@ void Scheduler::tickFCFS() {
     // 2. 执行进程
     if (runningProcess) {
         runningProcess->remainingTime--;
+        busyTime++;
 
         // 运行结束
         if (runningProcess->remainingTime <= 0) {
@@ -129,8 +178,7 @@ void Scheduler::tickRR() {
 
     // 1. 尝试调度
     if (!runningProcess && !readyQueue.empty()) {
-        runningProcess = readyQueue.front();
-        readyQueue.pop_front();
+        runningProcess = takeNextReady();
         runningProcess->state = RUNNING;
         currentSliceUsed = 0; // 重置时间片计数器
 
@@ -144,6 +192,7 @@ void Scheduler::tickRR() {
     // 2. 执行进程
     if (runningProcess) {
         runningProcess->remainingTime--;
+        busyTime++;
         currentSliceUsed++;
 
         // Case A: 进程执行完毕
@@ -178,16 +227,20 @@ void Scheduler::tickRR() {
 
 /* ================= 状态管理 ================= */
 
-void Scheduler::blockCurrentProcess() {
-    if (!runningProcess) return;
+unsigned long long Scheduler::blockCurrentProcess() {
+    if (!runningProcess) return 0;
+    unsigned long long token = ++lastWaitToken;
     runningProcess->state = BLOCKED;
+    runningProcess->waitToken = token;
     std::cout << "[System] Process " << runningProcess->pid << " blocked.\n";
     runningProcess = nullptr;
+    return token;
 }
 
 void Scheduler::wakeProcess(PCB* proc) {
     if (!proc || proc->state != BLOCKED) return;
     proc->state = READY;
+    proc->waitToken = 0;
     readyQueue.push_back(proc); // 放入 readyQueue
     std::cout << "[System] Process " << proc->pid << " awakened.\n";
 }
@@ -212,6 +265,7 @@ void Scheduler::activateProcess(const std::string& pid) {
     if (!p || p->state != SUSPENDED) return;
 
     p->state = READY;
+    p->waitToken = 0;
     readyQueue.push_back(p); // 
     std::cout << "[System] Process " << pid << " activated.\n";
 }
@@ -38,6 +38,12 @@ struct PCB {
     
     // 扩展字段
     int memSize; 
+    // 优先级（越大越优先）：priority 是设定值，effectivePriority 可能因优先级继承而临时升高
+    int priority;
+    int effectivePriority;
+    // 等待令牌：每次阻塞时分配新值，被任何途径唤醒时清零。等待队列记下阻塞时的令牌，
+    // 唤醒前核对，避免把已经转去等别的东西的进程错误唤醒
+    unsigned long long waitToken;
     std::vector<Thread> threads;
     
     // 银行家算法资源向量
@@ -48,11 +54,14 @@ struct PCB {
     // 构造函数：初始化所有字段，防止 vector 访问越界
     PCB(std::string id, int arr, int burst) 
         : pid(id), arrivalTime(arr), burstTime(burst), remainingTime(burst), 
-          startTime(-1), finishTime(-1), state(NEW), memSize(0),
+          startTime(-1), finishTime(-1), state(NEW), memSize(0), priority(0), effectivePriority(0), waitToken(0),
           maxResources({0, 0, 0}),        // 默认初始化为 0
           allocatedResources({0, 0, 0}),  // 默认初始化为 0
           neededResources({0, 0, 0})      // 默认初始化为 0
     {}
+
+    // 仍在进行令牌为 token 的那次等待
+    bool waitingOn(unsigned long long token) const { return state == BLOCKED && token != 0 && waitToken == token; }
 };
 
 class Scheduler {
@@ -67,11 +76,23 @@ public:
     // --- 进程与线程管理 ---
     void createProcess(const std::string& pid, int arrival, int burst, int memSize = 0);
     void createThread(const std::string& pid);
+    // fork：复制 PCB（剩余执行时间、内存大小、线程），子进程从当前时刻开始就绪
+    PCB* forkProcess(const std::string& parentPid, const std::string& childPid);
     
     PCB* getProcess(const std::string& pid);
     PCB* getRunningProcess() const { return runningProcess; }
     const std::vector<PCB*>& getAllProcesses() const { return allProcesses; }
     int getCurrentTime() const { return globalTime; }
+    int getOverheadTime() const { return overheadTime; }
+    // CPU 利用率：有进程在执行的 tick 占总时间的比例
+    int getBusyTime() const { return busyTime; }
+    double getCpuUtilization() const { return globalTime > 0 ? 100.0 * busyTime / globalTime : 0.0; }
+
+    // 系统开销（如内存紧凑）占用 CPU：时间前进，但没有进程得到执行
+    void chargeOverhead(int ticks, const std::string& reason);
+    // 没有可运行的进程（都在等 I/O）时直接快进最多 ticks 个空闲 tick，不逐个 tick 空转；
+    // 不会越过下一个进程的到达时间，返回实际快进的 tick 数
+    int idle(int ticks);
 
     void suspendProcess(const std::string& pid);
     void activateProcess(const std::string& pid);
@@ -87,7 +108,8 @@ public:
 
     // --- 同步与阻塞 ---
     void wakeProcess(PCB* proc);
-    void blockCurrentProcess();
+    // 阻塞当前进程，返回这次等待的令牌（没有运行的进程时返回 0）
+    unsigned long long blockCurrentProcess();
 
 private:
     // 调度算法具体实现
@@ -96,6 +118,8 @@ private:
 
     // 检查新到达的进程
     void checkArrivals();            
+    // 从就绪队列取出有效优先级最高的进程，同优先级按先来先服务
+    PCB* takeNextReady();
 
     // 银行家算法安全性检查
     bool checkSafety(const std::vector<int>& work, const std::vector<PCB*>& procs);
@@ -106,8 +130,11 @@ private:
     PCB* runningProcess = nullptr;      // 当前正在运行的进程
 
     int globalTime = 0;
+    int overheadTime = 0;               // 累计系统开销时间
+    int busyTime = 0;                   // 累计有进程执行的时间
     int currentSliceUsed = 0;
     int nextArrivalIdx = 0;            
+    unsigned long long lastWaitToken = 0;
 
     std::vector<int> availableResources{0, 0, 0}; // 系统当前可用资源
     SchedAlgorithm currentAlgorithm = ALG_FCFS;   // 默认调度算法
@@ -0,0 +1,146 @@
+#include "async_io.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+
+AsyncIo::AsyncIo(Scheduler& scheduler, StorageManager& disk)
+    : scheduler(scheduler),
+      disk(disk) {}
+
+bool AsyncIo::submit(PCB* proc, const std::string& path, int offset, int len, bool write, const std::string& preview) {
+    if (ops.count(proc->pid)) {
+        std::cout << "[AIO] Error: " << proc->pid << " already has an I/O in flight.\n";
+        return false;
+    }
+    int now = scheduler.getCurrentTime();
+    int requests = disk.submitIo(proc->pid, path, offset, len, write, now);
+    if (requests < 0) return false;
+    if (requests == 0) return true; // 没有涉及任何块，不必等待
+
+    Op op;
+    op.path = path;
+    op.write = write;
+    op.bytes = len;
+    op.remaining = requests;
+    op.submitted = now;
+    op.preview = preview;
+    std::cout << "[AIO] " << proc->pid << (write ? " writes " : " reads ") << len << " bytes "
+              << (write ? "to '" : "from '") << path << "' at offset " << offset << " (" << requests
+              << " disk request(s)), waiting.\n";
+    op.token = scheduler.blockCurrentProcess();
+    ops[proc->pid] = op;
+    maxWaiting = std::max(maxWaiting, static_cast<int>(ops.size()));
+    return true;
+}
+
+bool AsyncIo::read(const std::string& path, int offset, int len) {
+    PCB* proc = scheduler.getRunningProcess();
+    if (!proc) {
+        std::cout << "[AIO] Error: No running process.\n";
+        return false;
+    }
+    std::string buf(static_cast<size_t>(std::max(0, std::min(len, disk.getFileSize(path) - std::max(offset, 0)))), '\0');
+    int n = disk.pread(path, offset, &buf[0], static_cast<int>(buf.size()));
+    if (n < 0) {
+        std::cout << "[AIO] Error: File '" << path << "' not found.\n";
+        return false;
+    }
+    return submit(proc, path, offset, n, false, printableBytes(buf.substr(0, 32)));
+}
+
+bool AsyncIo::write(const std::string& path, int offset, const std::string& data) {
+    PCB* proc = scheduler.getRunningProcess();
+    if (!proc) {
+        std::cout << "[AIO] Error: No running process.\n";
+        return false;
+    }
+    int n = disk.pwrite(path, offset, data.data(), static_cast<int>(data.length()));
+    if (n < 0) return false;
+    return submit(proc, path, offset, n, true, "");
+}
+
+bool AsyncIo::addJob(const std::string& pid, const std::string& path, int cpuPerIo, int ioSize) {
+    PCB* proc = scheduler.getProcess(pid);
+    if (!proc || disk.getFileSize(path) <= 0 || cpuPerIo <= 0 || ioSize <= 0) {
+        std::cout << "[AIO] Error: Need an existing process, a non-empty file and positive intervals.\n";
+        return false;
+    }
+    Job job;
+    job.path = disk.absolutePath(path);
+    job.cpuPerIo = cpuPerIo;
+    job.ioSize = ioSize;
+    job.nextIoAt = proc->remainingTime - cpuPerIo;
+    jobs[pid] = job;
+    std::cout << "[AIO] " << pid << " reads " << ioSize << " bytes of '" << job.path << "' every "
+              << cpuPerIo << " tick(s) of CPU.\n";
+    return true;
+}
+
+void AsyncIo::tick() {
+    int now = scheduler.getCurrentTime();
+
+    // 1. 一次取回本 tick 之前完成的所有请求，操作的最后一个请求完成时唤醒进程
+    std::vector<DiskScheduler::Request> done = disk.tick(now);
+    if (!done.empty()) batches++;
+    for (const DiskScheduler::Request& req : done) {
+        completedRequests++;
+        auto it = ops.find(req.owner);
+        if (it == ops.end() || --it->second.remaining > 0) continue;
+
+        const Op& op = it->second;
+        waitTicks += now - op.submitted;
+        completedOps++;
+        std::cout << "[AIO] Time " << now << ": " << req.owner << (op.write ? " wrote " : " read ") << op.bytes
+                  << " bytes " << (op.write ? "to '" : "from '") << op.path << "' after " << now - op.submitted
+                  << " tick(s)";
+        if (!op.preview.empty()) std::cout << ": " << op.preview;
+        std::cout << "\n";
+        // 等待期间被别处唤醒过（wake 命令等）的进程不再等这次 I/O，即使它此刻又因别的原因阻塞
+        PCB* owner = scheduler.getProcess(req.owner);
+        if (owner && owner->waitingOn(op.token)) scheduler.wakeProcess(owner);
+        ops.erase(it);
+    }
+
+    // 2. I/O 型作业：执行够 cpuPerIo 个 tick 后发起下一次顺序读
+    PCB* proc = scheduler.getRunningProcess();
+    if (!proc) return;
+    auto jt = jobs.find(proc->pid);
+    if (jt == jobs.end() || proc->remainingTime <= 0 || proc->remainingTime > jt->second.nextIoAt) return;
+    Job& job = jt->second;
+    int size = disk.getFileSize(job.path);
+    if (size <= 0) {
+        jobs.erase(jt);
+        return;
+    }
+    job.offset %= size;
+    int len = std::min(job.ioSize, size - job.offset);
+    int offset = job.offset;
+    job.offset = (job.offset + len) % size;
+    job.nextIoAt = proc->remainingTime - job.cpuPerIo;
+    submit(proc, job.path, offset, len, false, "");
+}
+
+bool AsyncIo::idleUntilCompletion() {
+    double next = disk.nextIoCompletion();
+    if (ops.empty() || next < 0) return false;
+    int target = static_cast<int>(std::ceil(next));
+    int skipped = scheduler.idle(target - scheduler.getCurrentTime());
+    if (skipped > 0) idleSkips++;
+    return skipped > 0;
+}
+
+void AsyncIo::printStatus() const {
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "\n[Async I/O] Waiting: " << ops.size() << " process(es) (max " << maxWaiting << ")"
+              << " | I/O jobs: " << jobs.size() << " | Disk requests in queue: " << disk.pendingIo() << "\n";
+    std::cout << "  Completed: " << completedOps << " op(s), " << completedRequests << " request(s)"
+              << " | Mean wait: " << (completedOps > 0 ? static_cast<double>(waitTicks) / completedOps : 0.0) << " ticks"
+              << " | Batches: " << batches << " ("
+              << (batches > 0 ? static_cast<double>(completedRequests) / batches : 0.0) << " request(s)/batch)"
+              << " | Idle skips: " << idleSkips << "\n";
+    std::cout << "  CPU utilization: " << scheduler.getCpuUtilization() << "% (" << scheduler.getBusyTime() << "/"
+              << scheduler.getCurrentTime() << " ticks busy)\n";
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+}
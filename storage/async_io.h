@@ -0,0 +1,68 @@
+// storage/async_io.h
+#ifndef ASYNC_IO_H
+#define ASYNC_IO_H
+
+#include <string>
+#include <unordered_map>
+#include "storage.h"
+#include "../scheduler/scheduler.h"
+
+// 异步文件 I/O：进程发起读写后进入 BLOCKED，磁盘请求队列完成它的所有请求后再唤醒。
+// 数据在发起时就已读写完成（pread/pwrite），这里模拟的是等待磁盘的时间。
+//  - 每个 tick 只向磁盘队列取一次已完成的请求（一批），没有完成时代价为 O(1)，与未完成的请求数无关
+//  - 所有进程都在等 I/O 时，调度器直接快进到下一次完成，不逐 tick 空转
+class AsyncIo {
+public:
+    AsyncIo(Scheduler& scheduler, StorageManager& disk);
+
+    // 当前运行的进程读/写文件，成功发起后该进程阻塞
+    bool read(const std::string& path, int offset, int len);
+    bool write(const std::string& path, int offset, const std::string& data);
+
+    // I/O 型作业：进程每执行 cpuPerIo 个 tick 就顺序读文件的下 ioSize 字节
+    bool addJob(const std::string& pid, const std::string& path, int cpuPerIo, int ioSize);
+
+    // 每个调度 tick 之后调用：写回过期脏块、批量唤醒 I/O 已完成的进程、让到点的 I/O 型作业发起读
+    void tick();
+    // 没有可运行的进程时快进到下一次 I/O 完成，返回是否快进了
+    bool idleUntilCompletion();
+
+    int waiting() const { return static_cast<int>(ops.size()); }
+    void printStatus() const;
+
+private:
+    struct Op {
+        std::string path;
+        bool write = false;
+        int bytes = 0;
+        int remaining = 0;   // 尚未完成的磁盘请求数
+        int submitted = 0;   // 发起时间
+        unsigned long long token = 0; // 阻塞时得到的等待令牌，完成时仍匹配才唤醒
+        std::string preview; // 读到的数据开头（不可打印字节已转义），完成时显示
+    };
+    struct Job {
+        std::string path;
+        int cpuPerIo = 1;
+        int ioSize = BLOCK_SIZE;
+        int offset = 0;
+        int nextIoAt = 0;    // 剩余执行时间降到这个值时发起下一次 I/O
+    };
+
+    // 为 pid 发起一次 I/O 并阻塞它；磁盘请求数为 0（空区间）时不阻塞
+    bool submit(PCB* proc, const std::string& path, int offset, int len, bool write, const std::string& preview);
+
+    Scheduler& scheduler;
+    StorageManager& disk;
+    std::unordered_map<std::string, Op> ops;   // 每个阻塞进程至多一个未完成的操作
+    std::unordered_map<std::string, Job> jobs;
+
+    // 统计
+    long long completedOps = 0;
+    long long completedRequests = 0;
+    long long waitTicks = 0;
+    long long batches = 0;       // 有请求完成的 tick 数
+    long long idleSkips = 0;
+    int maxWaiting = 0;
+};
+
+#endif
@@ -0,0 +1,132 @@
+#include "block_bitmap.h"
+#include <algorithm>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// 位运算的编译器内建指令（MSVC 与 GCC/Clang 写法不同）
+static inline int countTrailingZeros(std::uint64_t w) {
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward64(&idx, w);
+    return static_cast<int>(idx);
+#else
+    return __builtin_ctzll(w);
+#endif
+}
+
+static inline int popCount(std::uint64_t w) {
+#ifdef _MSC_VER
+    return static_cast<int>(__popcnt64(w));
+#else
+    return __builtin_popcountll(w);
+#endif
+}
+
+static const std::uint64_t ALL_ONES = ~static_cast<std::uint64_t>(0);
+
+BlockBitmap::BlockBitmap(int blocks) {
+    reset(blocks);
+}
+
+void BlockBitmap::reset(int n) {
+    blocks = n > 0 ? n : 0;
+    freeBlocks = blocks;
+    words.assign(static_cast<size_t>((blocks + 63) / 64), 0);
+    // 最后一个字中超出磁盘范围的位置为占用，查找时不必单独判断边界
+    if (blocks % 64 != 0) words.back() = ALL_ONES << (blocks % 64);
+}
+
+void BlockBitmap::setRange(int start, int len, bool used) {
+    int end = std::min(start + len, blocks);
+    for (int i = std::max(start, 0); i < end;) {
+        int bit = i & 63;
+        int n = std::min(64 - bit, end - i);
+        std::uint64_t mask = (n == 64 ? ALL_ONES : ((static_cast<std::uint64_t>(1) << n) - 1)) << bit;
+        std::uint64_t& w = words[static_cast<size_t>(i >> 6)];
+        if (used) {
+            freeBlocks -= popCount(~w & mask);
+            w |= mask;
+        } else {
+            freeBlocks += popCount(w & mask);
+            w &= ~mask;
+        }
+        i += n;
+    }
+}
+
+void BlockBitmap::markUsed(int start, int len) { setRange(start, len, true); }
+void BlockBitmap::markFree(int start, int len) { setRange(start, len, false); }
+
+bool BlockBitmap::loadWords(const std::vector<std::uint64_t>& src) {
+    if (src.size() != words.size()) return false;
+    words = src;
+    if (blocks % 64 != 0) words.back() |= ALL_ONES << (blocks % 64);
+    freeBlocks = 0;
+    for (std::uint64_t w : words) freeBlocks += popCount(~w);
+    return true;
+}
+
+int BlockBitmap::nextFree(int from) const {
+    if (from >= blocks) return blocks;
+    size_t i = static_cast<size_t>(from >> 6);
+    std::uint64_t w = ~words[i] & (ALL_ONES << (from & 63));
+    while (w == 0) {
+        if (++i == words.size()) return blocks;
+        w = ~words[i]; // 全满的字直接跳过
+    }
+    return static_cast<int>(i * 64) + countTrailingZeros(w);
+}
+
+int BlockBitmap::nextUsed(int from) const {
+    if (from >= blocks) return blocks;
+    size_t i = static_cast<size_t>(from >> 6);
+    std::uint64_t w = words[i] & (ALL_ONES << (from & 63));
+    while (w == 0) {
+        if (++i == words.size()) return blocks;
+        w = words[i]; // 全空的字直接跳过
+    }
+    return std::min(blocks, static_cast<int>(i * 64) + countTrailingZeros(w));
+}
+
+std::vector<BlockBitmap::Extent> BlockBitmap::freeExtents() const {
+    std::vector<Extent> runs;
+    for (int s = nextFree(0); s < blocks;) {
+        int e = nextUsed(s);
+        runs.emplace_back(s, e - s);
+        s = nextFree(e);
+    }
+    return runs;
+}
+
+bool BlockBitmap::allocate(int count, std::vector<Extent>& out) {
+    out.clear();
+    if (count <= 0) return true;
+    if (count > freeBlocks) return false;
+
+    // 1. 首次适应：第一段足够长的连续空闲区
+    for (int s = nextFree(0); s < blocks;) {
+        int e = nextUsed(s);
+        if (e - s >= count) {
+            out.emplace_back(s, count);
+            markUsed(s, count);
+            return true;
+        }
+        s = nextFree(e);
+    }
+
+    // 2. 没有整段：从最长的空闲段开始拼，段数最少；结果按地址排序便于顺序读
+    std::vector<Extent> runs = freeExtents();
+    std::stable_sort(runs.begin(), runs.end(),
+                     [](const Extent& a, const Extent& b) { return a.second > b.second; });
+    int remaining = count;
+    for (const Extent& run : runs) {
+        int take = std::min(run.second, remaining);
+        out.emplace_back(run.first, take);
+        remaining -= take;
+        if (remaining == 0) break;
+    }
+    std::sort(out.begin(), out.end());
+    for (const Extent& ext : out) markUsed(ext.first, ext.second);
+    return true;
+}
@@ -0,0 +1,49 @@
+// storage/block_bitmap.h
+#ifndef BLOCK_BITMAP_H
+#define BLOCK_BITMAP_H
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+// 磁盘块位示图：每 64 个块压成一个字 (1=占用, 0=空闲)
+// 查找空闲块时整字跳过全满/全空的区域，字内用 count-trailing-zeros 定位，
+// 空闲块数单独维护，不需要扫描。
+class BlockBitmap {
+public:
+    using Extent = std::pair<int, int>; // (起始块号, 块数)
+
+    explicit BlockBitmap(int blocks = 0);
+
+    void reset(int blocks); // 重新设定块数并全部置为空闲
+    int size() const { return blocks; }
+    int freeCount() const { return freeBlocks; }
+    int usedCount() const { return blocks - freeBlocks; }
+
+    bool test(int block) const { return (words[block >> 6] >> (block & 63)) & 1U; }
+    void markUsed(int start, int len);
+    void markFree(int start, int len);
+
+    // 分配 count 个块：优先一整段连续空闲区（首次适应），
+    // 没有时按空闲段从大到小拼凑，尽量减少段数。失败时不修改位图
+    bool allocate(int count, std::vector<Extent>& out);
+
+    // 从 from 开始的第一个空闲/已用块，没有时返回 size()
+    int nextFree(int from) const;
+    int nextUsed(int from) const;
+    // 所有连续空闲段（按地址）
+    std::vector<Extent> freeExtents() const;
+
+    // 原始字数组（持久化用）；载入时按字恢复并重新统计空闲块数
+    const std::vector<std::uint64_t>& getWords() const { return words; }
+    bool loadWords(const std::vector<std::uint64_t>& src);
+
+private:
+    void setRange(int start, int len, bool used);
+
+    int blocks = 0;
+    int freeBlocks = 0;
+    std::vector<std::uint64_t> words;
+};
+
+#endif
@@ -0,0 +1,168 @@
+#include "buffer_cache.h"
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+
+BufferCache::BufferCache(DiskImage& image, int blockSize, int capacity)
+    : image(image),
+      blockSize(blockSize) {
+    resize(capacity);
+}
+
+void BufferCache::resize(int capacity) {
+    if (!buffers.empty()) flush();
+    if (capacity < 1) capacity = 1;
+    buffers.assign(static_cast<std::size_t>(capacity), Buffer());
+    pool.assign(static_cast<std::size_t>(capacity) * blockSize, 0);
+    index.clear();
+    hand = 0;
+}
+
+/* ================= 查找与淘汰 ================= */
+
+int BufferCache::lookup(int block, bool load, bool& hit) {
+    auto it = index.find(block);
+    hit = it != index.end();
+    if (hit) return it->second;
+
+    int slot = evict();
+    Buffer& buf = buffers[static_cast<std::size_t>(slot)];
+    buf.block = block;
+    buf.dirty = false;
+    buf.prefetched = false;
+    index[block] = slot;
+    if (load) {
+        std::memcpy(slotData(slot), image.block(block), static_cast<std::size_t>(blockSize));
+        diskReads++;
+    }
+    return slot;
+}
+
+// CLOCK：指针扫过的块若最近被访问过则给第二次机会，否则淘汰
+int BufferCache::evict() {
+    while (true) {
+        int slot = hand;
+        hand = (hand + 1) % static_cast<int>(buffers.size());
+        Buffer& buf = buffers[static_cast<std::size_t>(slot)];
+        if (buf.block < 0) return slot;
+        if (buf.referenced) {
+            buf.referenced = false;
+            continue;
+        }
+        if (buf.dirty) {
+            writeBack(slot);
+            dirtyEvictions++;
+        }
+        index.erase(buf.block);
+        buf.block = -1;
+        evictions++;
+        return slot;
+    }
+}
+
+void BufferCache::writeBack(int slot) {
+    Buffer& buf = buffers[static_cast<std::size_t>(slot)];
+    std::memcpy(image.block(buf.block), slotData(slot), static_cast<std::size_t>(blockSize));
+    buf.dirty = false;
+    dirtyBlocks--;
+}
+
+/* ================= 读写 ================= */
+
+void BufferCache::read(int block, std::size_t offset, char* out, std::size_t len) {
+    bool hit;
+    int slot = lookup(block, true, hit);
+    Buffer& buf = buffers[static_cast<std::size_t>(slot)];
+    if (hit) hits++;
+    else misses++;
+    if (buf.prefetched) {
+        buf.prefetched = false;
+        prefetchHits++;
+    }
+    buf.referenced = true;
+    std::memcpy(out, slotData(slot) + offset, len);
+}
+
+void BufferCache::write(int block, std::size_t offset, const char* data, std::size_t len) {
+    bool whole = offset == 0 && len == static_cast<std::size_t>(blockSize);
+    bool hit;
+    int slot = lookup(block, !whole, hit);
+    Buffer& buf = buffers[static_cast<std::size_t>(slot)];
+    if (hit) hits++;
+    else misses++;
+    buf.prefetched = false;
+    buf.referenced = true;
+    if (data) std::memcpy(slotData(slot) + offset, data, len);
+    else std::memset(slotData(slot) + offset, 0, len);
+    if (!buf.dirty) {
+        buf.dirty = true;
+        buf.dirtySince = now;
+        dirtyBlocks++;
+    }
+}
+
+void BufferCache::prefetch(int block) {
+    if (index.count(block)) return;
+    bool hit;
+    int slot = lookup(block, true, hit);
+    Buffer& buf = buffers[static_cast<std::size_t>(slot)];
+    buf.prefetched = true;
+    buf.referenced = true; // 给一次机会：预读块马上就要被用到，不能先于它前面的块被淘汰
+    prefetches++;
+}
+
+void BufferCache::invalidate(int block) {
+    auto it = index.find(block);
+    if (it == index.end()) return;
+    Buffer& buf = buffers[static_cast<std::size_t>(it->second)];
+    if (buf.dirty) {
+        dirtyBlocks--;
+        discarded++;
+    }
+    buf = Buffer();
+    index.erase(it);
+}
+
+/* ================= 写回 ================= */
+
+int BufferCache::flush() {
+    int written = 0;
+    for (std::size_t i = 0; i < buffers.size(); ++i) {
+        if (buffers[i].block >= 0 && buffers[i].dirty) {
+            writeBack(static_cast<int>(i));
+            written++;
+        }
+    }
+    flushedBlocks += written;
+    return written;
+}
+
+int BufferCache::tick(int time) {
+    now = time;
+    if (dirtyBlocks == 0) return 0;
+    int written = 0;
+    for (std::size_t i = 0; i < buffers.size(); ++i) {
+        const Buffer& buf = buffers[i];
+        if (buf.block >= 0 && buf.dirty && now - buf.dirtySince >= FLUSH_AGE) {
+            writeBack(static_cast<int>(i));
+            written++;
+        }
+    }
+    flushedBlocks += written;
+    return written;
+}
+
+void BufferCache::printStatus() const {
+    long long accesses = hits + misses;
+    std::cout << "\n[Buffer Cache] " << index.size() << "/" << buffers.size() << " blocks ("
+              << buffers.size() * static_cast<std::size_t>(blockSize) << " bytes) | Dirty: " << dirtyBlocks << "\n";
+    std::cout << std::fixed << std::setprecision(1)
+              << "  Hits: " << hits << " | Misses: " << misses
+              << " | Hit rate: " << (accesses > 0 ? 100.0 * hits / accesses : 0.0) << "%"
+              << " | Disk reads: " << diskReads << "\n";
+    std::cout << "  Read-ahead: " << prefetches << " issued, " << prefetchHits << " used"
+              << " | Evictions: " << evictions << " (" << dirtyEvictions << " dirty)"
+              << " | Flushed: " << flushedBlocks << " block(s) | Discarded: " << discarded << "\n";
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+}
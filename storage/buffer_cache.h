@@ -0,0 +1,77 @@
+// storage/buffer_cache.h
+#ifndef BUFFER_CACHE_H
+#define BUFFER_CACHE_H
+
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+#include "disk_image.h"
+
+// 块缓冲区缓存：文件读写与磁盘镜像之间的一层，固定容量（块数）
+//  - 哈希表按块号查找缓冲区，CLOCK（二次机会）算法淘汰
+//  - 写回策略：写只改缓存并标脏，淘汰时、脏块超过 FLUSH_AGE 个 tick 时或 sync 时才写回磁盘
+//  - 预读：顺序读文件时由调用者提前调入后续块，预读块第一次被用到时计为预读命中
+class BufferCache {
+public:
+    BufferCache(DiskImage& image, int blockSize, int capacity = 64);
+    ~BufferCache() { flush(); }
+
+    // 读/写某块中的一段；写整块时不必先从磁盘读入
+    void read(int block, std::size_t offset, char* out, std::size_t len);
+    void write(int block, std::size_t offset, const char* data, std::size_t len);
+    // 预读：块不在缓存中时调入，不计入命中/缺失
+    void prefetch(int block);
+    // 块被释放：丢弃缓存（脏数据也不再写回）
+    void invalidate(int block);
+
+    // 写回所有脏块
+    int flush();
+    // 周期性写回：推进时钟，写回脏了太久的块
+    int tick(int now);
+
+    // 改变容量（先写回并清空缓存）
+    void resize(int capacity);
+    int getCapacity() const { return static_cast<int>(buffers.size()); }
+    int dirtyCount() const { return dirtyBlocks; }
+
+    void printStatus() const;
+
+private:
+    static constexpr int FLUSH_AGE = 5; // 脏块最长滞留 tick 数
+
+    struct Buffer {
+        int block = -1;
+        bool dirty = false;
+        bool referenced = false; // CLOCK 的访问位
+        bool prefetched = false; // 预读调入、尚未被访问
+        int dirtySince = 0;
+    };
+
+    // 找到（或调入）某块所在的槽位；load=false 时不从磁盘读入内容
+    int lookup(int block, bool load, bool& hit);
+    int evict();
+    void writeBack(int slot);
+    char* slotData(int slot) { return pool.data() + static_cast<std::size_t>(slot) * blockSize; }
+
+    DiskImage& image;
+    int blockSize;
+    std::vector<Buffer> buffers;
+    std::vector<char> pool; // 所有缓冲区的数据，capacity * blockSize 字节
+    std::unordered_map<int, int> index; // 块号 -> 槽位
+    int hand = 0;
+    int now = 0;
+    int dirtyBlocks = 0;
+
+    // 统计
+    long long hits = 0;
+    long long misses = 0;
+    long long diskReads = 0;
+    long long prefetches = 0;
+    long long prefetchHits = 0;
+    long long evictions = 0;
+    long long dirtyEvictions = 0;
+    long long flushedBlocks = 0; // sync/周期写回的块数（不含淘汰时的写回）
+    long long discarded = 0;     // 块释放时丢弃、省掉的写回
+};
+
+#endif
@@ -0,0 +1,42 @@
+#include "dentry_cache.h"
+
+DentryCache::DentryCache(int capacity)
+    : capacity(capacity > 0 ? capacity : 1) {}
+
+int DentryCache::lookup(const std::string& path) {
+    auto it = index.find(path);
+    if (it == index.end()) {
+        misses++;
+        return -1;
+    }
+    entries.splice(entries.begin(), entries, it->second);
+    hits++;
+    return it->second->second;
+}
+
+void DentryCache::insert(const std::string& path, int ino) {
+    auto it = index.find(path);
+    if (it != index.end()) {
+        it->second->second = ino;
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+    if (static_cast<int>(entries.size()) >= capacity) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+    entries.emplace_front(path, ino);
+    index[path] = entries.begin();
+}
+
+void DentryCache::invalidate(const std::string& path) {
+    auto it = index.find(path);
+    if (it == index.end()) return;
+    entries.erase(it->second);
+    index.erase(it);
+}
+
+void DentryCache::clear() {
+    entries.clear();
+    index.clear();
+}
@@ -0,0 +1,38 @@
+// storage/dentry_cache.h
+#ifndef DENTRY_CACHE_H
+#define DENTRY_CACHE_H
+
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+// 目录项缓存：规范化的绝对路径 -> inode 号，LRU 替换
+// 命中时路径解析不必逐级查目录；删除文件或目录时由调用者作废对应路径。
+class DentryCache {
+public:
+    explicit DentryCache(int capacity = 1024);
+
+    // 命中返回 inode 号，未命中返回 -1
+    int lookup(const std::string& path);
+    void insert(const std::string& path, int ino);
+    void invalidate(const std::string& path);
+    void clear();
+
+    int size() const { return static_cast<int>(entries.size()); }
+    int getCapacity() const { return capacity; }
+    long long getHits() const { return hits; }
+    long long getMisses() const { return misses; }
+
+private:
+    using Entry = std::pair<std::string, int>;
+
+    int capacity;
+    std::list<Entry> entries; // 队头为最近使用
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+
+    long long hits = 0;
+    long long misses = 0;
+};
+
+#endif
@@ -0,0 +1,27 @@
+#include "disk_format.h"
+
+namespace diskfmt {
+
+namespace {
+struct CrcTable {
+    std::uint32_t entry[256];
+    CrcTable() {
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            std::uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1U) ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+            entry[i] = c;
+        }
+    }
+};
+} // namespace
+
+// 查表法 CRC-32，表在第一次调用时生成
+std::uint32_t crc32(const void* data, std::size_t len) {
+    static const CrcTable table;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    std::uint32_t crc = 0xFFFFFFFFU;
+    for (std::size_t i = 0; i < len; ++i) crc = table.entry[(crc ^ p[i]) & 0xFFU] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFU;
+}
+
+} // namespace diskfmt
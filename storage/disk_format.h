@@ -0,0 +1,76 @@
+// storage/disk_format.h
+#ifndef DISK_FORMAT_H
+#define DISK_FORMAT_H
+
+#include <cstdint>
+#include <cstddef>
+
+// 虚拟磁盘元数据文件的二进制格式（版本 3），各区都在固定偏移处，便于原地增量改写：
+//   [超级块 64B][inode 表: slots x 128B][位示图: ceil(blocks/64) x 8B][块校验和: blocks x 4B]
+// 文件数据本身不在这里，而在 mmap 的磁盘镜像中。
+namespace diskfmt {
+
+const char MAGIC[4] = {'O', 'S', 'F', 'S'};
+const std::uint32_t VERSION = 3;   // 版本 2：加入目录；版本 3：加入快照
+const std::uint32_t MIN_VERSION = 2; // 版本 2 的文件没有快照，可直接载入
+const int NAME_LEN = 36;           // 单级名字，含结尾 '\0'
+const int EXTENTS_PER_RECORD = 8;
+const int MIN_INODE_SLOTS = 64;
+
+enum RecordType : std::uint32_t {
+    RECORD_FREE = 0,
+    RECORD_INODE = 1,
+    RECORD_EXTENT = 2, // 续表：inode 放不下的连续段
+    RECORD_DIR = 3,    // 目录 inode：目录项不单独存放，由各子节点的 parent 还原
+    RECORD_SNAPSHOT = 4 // 快照头：name 为快照名，createdAt 为创建时间
+};
+
+// type 的低 8 位为记录种类，高位为所属快照头的记录号 + 1（0 表示当前文件树）
+inline std::uint32_t recordKind(std::uint32_t type) { return type & 0xFF; }
+inline int recordOwner(std::uint32_t type) { return static_cast<int>(type >> 8) - 1; }
+inline std::uint32_t makeRecordType(std::uint32_t kind, int ownerSlot) {
+    return kind | (static_cast<std::uint32_t>(ownerSlot + 1) << 8);
+}
+
+struct Superblock {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t blockSize;
+    std::uint32_t totalBlocks;
+    std::uint32_t inodeSlots;
+    std::uint32_t generation;      // 每次保存加一
+    std::uint64_t inodeOffset;
+    std::uint64_t bitmapOffset;
+    std::uint64_t checksumOffset;
+    std::uint32_t checksum;        // 覆盖本结构前面所有字段
+    std::uint8_t reserved[12];
+};
+
+struct ExtentRecord {
+    std::int32_t start;
+    std::int32_t count;
+};
+
+// inode 与续表共用同一种 128 字节记录，next 把一个文件的多条记录串起来；
+// parent 为所在目录 inode 的第一条记录号，根目录下为 -1
+struct InodeRecord {
+    std::uint32_t type;
+    std::int32_t next;
+    std::uint32_t extentCount;
+    std::int32_t size;
+    std::int32_t length;
+    std::int32_t createdAt;
+    std::int32_t parent;
+    char name[NAME_LEN];
+    ExtentRecord extents[EXTENTS_PER_RECORD];
+};
+
+static_assert(sizeof(Superblock) == 64, "superblock layout");
+static_assert(sizeof(InodeRecord) == 128, "inode record layout");
+
+// CRC-32 (IEEE 802.3)
+std::uint32_t crc32(const void* data, std::size_t len);
+
+} // namespace diskfmt
+
+#endif
@@ -0,0 +1,119 @@
+#include "disk_image.h"
+#include <iostream>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+DiskImage::DiskImage(const std::string& path, int blocks, int blockSize)
+    : path(path),
+      blocks(blocks),
+      blockSize(blockSize),
+      length(static_cast<std::size_t>(blocks) * static_cast<std::size_t>(blockSize)) {
+    if (length == 0) return;
+    if (!mapFile()) {
+        std::cout << "[Disk] Warning: cannot map image '" << path << "', using memory only.\n";
+        fallback.assign(length, 0);
+        base = fallback.data();
+    }
+}
+
+DiskImage::~DiskImage() {
+    unmapFile();
+}
+
+#ifdef _WIN32
+
+bool DiskImage::mapFile() {
+    HANDLE file = INVALID_HANDLE_VALUE;
+    if (!path.empty()) {
+        file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                           OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+    }
+
+    LARGE_INTEGER size;
+    size.QuadPart = static_cast<LONGLONG>(length);
+    // 无文件时由页面文件支持，页面在第一次访问时才分配
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, size.HighPart, size.LowPart, nullptr);
+    if (mapping == nullptr) {
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, length);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    base = static_cast<char*>(view);
+    mapped = true;
+    return true;
+}
+
+void DiskImage::unmapFile() {
+    if (!mapped) return;
+    FlushViewOfFile(base, 0);
+    UnmapViewOfFile(base);
+    CloseHandle(static_cast<HANDLE>(mappingHandle));
+    if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(static_cast<HANDLE>(fileHandle));
+    mapped = false;
+}
+
+void DiskImage::sync() {
+    if (mapped && !path.empty()) FlushViewOfFile(base, 0);
+}
+
+#else
+
+bool DiskImage::mapFile() {
+    if (path.empty()) {
+        void* addr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (addr == MAP_FAILED) return false;
+        base = static_cast<char*>(addr);
+        mapped = true;
+        return true;
+    }
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return false;
+
+    // 镜像大小与磁盘容量不符时调整；扩展出的部分是稀疏的，不占实际磁盘空间
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        (static_cast<std::size_t>(st.st_size) != length && ftruncate(fd, static_cast<off_t>(length)) != 0)) {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+
+    void* addr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    base = static_cast<char*>(addr);
+    mapped = true;
+    return true;
+}
+
+void DiskImage::unmapFile() {
+    if (!mapped) return;
+    munmap(base, length);
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+    mapped = false;
+}
+
+void DiskImage::sync() {
+    if (mapped && fd >= 0) msync(base, length, MS_SYNC);
+}
+
+#endif
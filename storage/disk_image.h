@@ -0,0 +1,52 @@
+// storage/disk_image.h
+#ifndef DISK_IMAGE_H
+#define DISK_IMAGE_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// 块设备镜像：宿主机上的一个镜像文件，整体 mmap 到内存，按块号直接寻址
+// 读写只触及用到的块，由操作系统的页缓存负责按需调入与回写，
+// 因此几 GB 的镜像也能瞬间"打开"，不需要整体读入或解析。
+// 路径为空时映射匿名内存（按需分配、全零、不落盘），用于不需要持久化的运行；
+// 无法映射时退化为进程内的内存缓冲（内容同样不落盘）。
+class DiskImage {
+public:
+    DiskImage(const std::string& path, int blocks, int blockSize);
+    ~DiskImage();
+
+    DiskImage(const DiskImage&) = delete;
+    DiskImage& operator=(const DiskImage&) = delete;
+
+    char* block(int idx) { return base + static_cast<std::size_t>(idx) * blockSize; }
+    const char* block(int idx) const { return base + static_cast<std::size_t>(idx) * blockSize; }
+
+    int getBlockCount() const { return blocks; }
+    const std::string& getPath() const { return path; }
+    bool isMapped() const { return mapped; }
+
+    // 把脏页刷回镜像文件
+    void sync();
+
+private:
+    bool mapFile();
+    void unmapFile();
+
+    std::string path;
+    int blocks;
+    int blockSize;
+    std::size_t length;
+    char* base = nullptr;
+    bool mapped = false;
+    std::vector<char> fallback;
+
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+#endif
@@ -0,0 +1,242 @@
+#include "disk_scheduler.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <iterator>
+#include <cctype>
+
+DiskScheduler::DiskScheduler(int totalBlocks, Algorithm algorithm)
+    : totalBlocks(std::max(totalBlocks, 1)),
+      tracks((std::max(totalBlocks, 1) + BLOCKS_PER_TRACK - 1) / BLOCKS_PER_TRACK),
+      algorithm(algorithm) {}
+
+const char* DiskScheduler::algorithmName(Algorithm algorithm) {
+    switch (algorithm) {
+        case Algorithm::FCFS: return "FCFS";
+        case Algorithm::SSTF: return "SSTF";
+        case Algorithm::SCAN: return "SCAN";
+        case Algorithm::CSCAN: return "C-SCAN";
+        case Algorithm::LOOK: return "LOOK";
+        case Algorithm::CLOOK: return "C-LOOK";
+    }
+    return "?";
+}
+
+bool DiskScheduler::parseAlgorithm(const std::string& name, Algorithm& out) {
+    std::string n;
+    for (char c : name) {
+        if (c != '-' && c != '_') n += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    if (n == "fcfs") out = Algorithm::FCFS;
+    else if (n == "sstf") out = Algorithm::SSTF;
+    else if (n == "scan") out = Algorithm::SCAN;
+    else if (n == "cscan") out = Algorithm::CSCAN;
+    else if (n == "look") out = Algorithm::LOOK;
+    else if (n == "clook") out = Algorithm::CLOOK;
+    else return false;
+    return true;
+}
+
+long long DiskScheduler::submit(const std::string& owner, int block, int count, bool write, double now) {
+    Request req;
+    req.id = nextId++;
+    req.owner = owner;
+    req.block = std::min(std::max(block, 0), totalBlocks - 1);
+    req.count = std::max(count, 1);
+    req.write = write;
+    req.arrival = now;
+    // 调用者按时间顺序提交；万一时间倒退，按到达时间插入
+    auto pos = incoming.end();
+    while (pos != incoming.begin() && std::prev(pos)->arrival > now) --pos;
+    incoming.insert(pos, req);
+    if (firstArrival < 0 || now < firstArrival) firstArrival = now;
+    return req.id;
+}
+
+/* ================= 代价模型 ================= */
+
+double DiskScheduler::seekTime(int distance) const {
+    return distance == 0 ? 0.0 : SEEK_SETTLE_MS + SEEK_FACTOR_MS * std::sqrt(static_cast<double>(distance));
+}
+
+double DiskScheduler::moveHead(int track) {
+    int distance = std::abs(track - head);
+    headTravel += distance;
+    head = track;
+    return seekTime(distance);
+}
+
+double DiskScheduler::rotationalDelay(double t, int block) const {
+    const double perBlock = ROTATION_MS / BLOCKS_PER_TRACK;
+    double position = std::fmod(t, ROTATION_MS) / perBlock; // 当前磁头下的扇区（可为小数）
+    int sector = block % BLOCKS_PER_TRACK;
+    return std::fmod(sector - position + BLOCKS_PER_TRACK, static_cast<double>(BLOCKS_PER_TRACK)) * perBlock;
+}
+
+/* ================= 调度 ================= */
+
+void DiskScheduler::admit(double t) {
+    while (!incoming.empty() && incoming.front().arrival <= t) {
+        const Request& req = incoming.front();
+        auto it = byBlock.emplace(req.block, req);
+        byArrival[req.id] = it;
+        incoming.pop_front();
+    }
+}
+
+// 队列按块号排序，每种算法都只需一次 O(log n) 的查找
+DiskScheduler::Queue::iterator DiskScheduler::pick(double& t) {
+    const int headFirst = head * BLOCKS_PER_TRACK;           // 当前磁道的第一块
+    const int headLast = headFirst + BLOCKS_PER_TRACK - 1;   // 当前磁道的最后一块
+    auto trackOf = [](const Queue::iterator& it) { return it->first / BLOCKS_PER_TRACK; };
+
+    switch (algorithm) {
+        case Algorithm::FCFS:
+            return byArrival.begin()->second;
+
+        case Algorithm::SSTF: {
+            // 最近的请求在 head 两侧相邻的位置之一
+            auto up = byBlock.lower_bound(headFirst);
+            if (up == byBlock.begin()) return up;
+            auto down = std::prev(up);
+            if (up == byBlock.end()) return down;
+            return trackOf(up) - head <= head - trackOf(down) ? up : down;
+        }
+
+        case Algorithm::SCAN:
+        case Algorithm::LOOK:
+            for (int pass = 0; pass < 2; ++pass) {
+                if (direction > 0) {
+                    auto it = byBlock.lower_bound(headFirst);
+                    if (it != byBlock.end()) return it;
+                } else {
+                    auto it = byBlock.upper_bound(headLast);
+                    if (it != byBlock.begin()) return std::prev(it);
+                }
+                // 这个方向已没有请求：SCAN 要先走到盘边再折返，LOOK 直接折返
+                if (algorithm == Algorithm::SCAN) t += moveHead(direction > 0 ? tracks - 1 : 0);
+                direction = -direction;
+            }
+            return byBlock.begin(); // 不会到达
+
+        case Algorithm::CSCAN:
+        case Algorithm::CLOOK: {
+            auto it = byBlock.lower_bound(headFirst);
+            if (it != byBlock.end()) return it;
+            // 单向扫描：C-SCAN 走到盘边后回到 0 道，C-LOOK 直接跳到最低的请求
+            if (algorithm == Algorithm::CSCAN) {
+                t += moveHead(tracks - 1);
+                t += moveHead(0);
+            }
+            return byBlock.begin();
+        }
+    }
+    return byBlock.begin();
+}
+
+std::vector<DiskScheduler::Request> DiskScheduler::advance(double now) {
+    // 磁盘空闲（上一个请求已完成）时才选下一个请求：选择时只看那一刻已到达的请求
+    while (true) {
+        double t = busyUntil;
+        admit(t);
+        if (byBlock.empty()) {
+            if (incoming.empty()) break;
+            t = std::max(t, incoming.front().arrival);
+            admit(t);
+        }
+        if (t > now) break;
+
+        double begin = t;
+        auto it = pick(t);
+        Request req = it->second;
+        byArrival.erase(req.id);
+        byBlock.erase(it);
+
+        req.start = begin;
+        t += moveHead(req.block / BLOCKS_PER_TRACK);
+        t += rotationalDelay(t, req.block);
+        t += req.count * (ROTATION_MS / BLOCKS_PER_TRACK);
+        req.finish = t;
+        busyUntil = t;
+        busyTime += t - begin;
+        inService.push_back(req);
+    }
+
+    std::vector<Request> done;
+    while (!inService.empty() && inService.front().finish <= now) {
+        const Request& req = inService.front();
+        completed++;
+        serviceSum += req.finish - req.start;
+        responses.push_back(req.finish - req.arrival);
+        lastFinish = std::max(lastFinish, req.finish);
+        done.push_back(req);
+        inService.pop_front();
+    }
+    return done;
+}
+
+std::vector<DiskScheduler::Request> DiskScheduler::drain() {
+    return advance(std::numeric_limits<double>::infinity());
+}
+
+/* ================= 统计 ================= */
+
+void DiskScheduler::resetStats() {
+    completed = 0;
+    headTravel = 0;
+    busyTime = 0;
+    serviceSum = 0;
+    firstArrival = incoming.empty() ? -1 : incoming.front().arrival;
+    lastFinish = 0;
+    responses.clear();
+}
+
+double DiskScheduler::getThroughput() const {
+    double elapsed = lastFinish - firstArrival;
+    return completed > 0 && elapsed > 0 ? completed * 1000.0 / elapsed : 0.0;
+}
+
+double DiskScheduler::getMeanResponse() const {
+    if (responses.empty()) return 0.0;
+    double sum = 0;
+    for (double r : responses) sum += r;
+    return sum / static_cast<double>(responses.size());
+}
+
+double DiskScheduler::percentileResponse(double p) const {
+    if (responses.empty()) return 0.0;
+    std::vector<double> sorted = responses;
+    size_t k = std::min(sorted.size() - 1, static_cast<size_t>(p / 100.0 * static_cast<double>(sorted.size())));
+    std::nth_element(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(k), sorted.end());
+    return sorted[k];
+}
+
+void DiskScheduler::printStatus() const {
+    double elapsed = lastFinish - firstArrival;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "\n[Disk Queue] Algorithm: " << algorithmName(algorithm) << " | " << tracks << " tracks ("
+              << BLOCKS_PER_TRACK << " blocks/track) | Head: track " << head << " | Pending: " << pending() << "\n";
+    std::cout << "  Completed: " << completed << " | Throughput: " << getThroughput() << " req/s"
+              << " | Utilization: " << (completed > 0 && elapsed > 0 ? 100.0 * busyTime / elapsed : 0.0) << "%\n";
+    std::cout << "  Response (ms) mean: " << getMeanResponse() << " | p95: " << percentileResponse(95)
+              << " | p99: " << percentileResponse(99) << " | max: " << percentileResponse(100)
+              << " | Service mean: " << (completed > 0 ? serviceSum / completed : 0.0) << " ms\n";
+    std::cout << "  Head travel: " << headTravel << " tracks ("
+              << (completed > 0 ? static_cast<double>(headTravel) / completed : 0.0) << " per request)\n";
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+}
+
+void DiskScheduler::printSummary() const {
+    std::cout << std::fixed << std::setprecision(2) << std::left
+              << std::setw(8) << algorithmName(algorithm) << std::right
+              << std::setw(11) << getThroughput()
+              << std::setw(10) << getMeanResponse()
+              << std::setw(10) << percentileResponse(95)
+              << std::setw(10) << percentileResponse(99)
+              << std::setw(12) << headTravel << "\n";
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+}
@@ -0,0 +1,101 @@
+// storage/disk_scheduler.h
+#ifndef DISK_SCHEDULER_H
+#define DISK_SCHEDULER_H
+
+#include <string>
+#include <map>
+#include <deque>
+#include <vector>
+
+// 磁盘请求队列与磁头调度
+// 磁盘按每道 BLOCKS_PER_TRACK 块划分磁道，服务一个请求的时间 = 寻道 + 旋转等待 + 传输：
+//   寻道时间 = SEEK_SETTLE_MS + SEEK_FACTOR_MS * sqrt(磁道距离)（距离为 0 时不寻道）
+//   旋转等待 = 盘片转到目标扇区所需时间（按模拟时钟推算盘片位置）
+//   传输时间 = 块数 * 每块经过磁头的时间
+// 时间单位为毫秒，与调度器的 tick 一一对应。
+class DiskScheduler {
+public:
+    enum class Algorithm { FCFS, SSTF, SCAN, CSCAN, LOOK, CLOOK };
+
+    struct Request {
+        long long id = 0;
+        std::string owner;   // 发起请求的进程
+        int block = 0;       // 起始物理块
+        int count = 1;       // 连续块数
+        bool write = false;
+        double arrival = 0;
+        double start = 0;    // 开始服务（磁头开始移动）的时间
+        double finish = 0;
+    };
+
+    static constexpr int BLOCKS_PER_TRACK = 8;
+    static constexpr double SEEK_SETTLE_MS = 1.0;
+    static constexpr double SEEK_FACTOR_MS = 0.2;
+    static constexpr double ROTATION_MS = 8.0; // 7500 rpm
+
+    explicit DiskScheduler(int totalBlocks, Algorithm algorithm = Algorithm::FCFS);
+
+    // 请求进入队列，返回请求号
+    long long submit(const std::string& owner, int block, int count, bool write, double now);
+    // 推进到 now：按当前算法依次服务已到达的请求，返回 now 之前完成的请求（按完成时间排序）
+    std::vector<Request> advance(double now);
+    // 服务完队列中的所有请求
+    std::vector<Request> drain();
+
+    void setAlgorithm(Algorithm algorithm) { this->algorithm = algorithm; }
+    Algorithm getAlgorithm() const { return algorithm; }
+    static const char* algorithmName(Algorithm algorithm);
+    static bool parseAlgorithm(const std::string& name, Algorithm& out);
+
+    int pending() const { return static_cast<int>(incoming.size() + byBlock.size() + inService.size()); }
+    // 正在服务的请求的完成时间（advance 之后磁盘空闲则为 -1），用于空闲时直接快进到下一次完成
+    double nextCompletion() const { return inService.empty() ? -1.0 : inService.front().finish; }
+    int getTracks() const { return tracks; }
+
+    void resetStats();
+    void printStatus() const;
+    // 一行汇总，供对比各算法
+    void printSummary() const;
+
+    double getThroughput() const;   // 每秒完成的请求数
+    double getMeanResponse() const; // 平均响应时间（到达 -> 完成）
+    double percentileResponse(double p) const;
+    long long getHeadTravel() const { return headTravel; }
+
+private:
+    using Queue = std::multimap<int, Request>; // 按起始块号排序
+
+    // 在 t 时刻选出下一个请求；SCAN/C-SCAN 需要先把磁头移到盘边时把这段时间与行程计入 t
+    Queue::iterator pick(double& t);
+    double seekTime(int distance) const;
+    // 磁头移到 track，返回寻道时间并累计行程
+    double moveHead(int track);
+    // t 时刻磁头位于目标磁道，等待 block 转到磁头下的时间
+    double rotationalDelay(double t, int block) const;
+    void admit(double t);
+
+    int totalBlocks;
+    int tracks;
+    Algorithm algorithm;
+
+    std::deque<Request> incoming;  // 已提交、按到达时间排序，尚未进入调度队列
+    Queue byBlock;                 // 已到达、等待调度的请求
+    std::map<long long, Queue::iterator> byArrival; // FCFS 用：请求号即到达顺序
+    std::deque<Request> inService; // 已安排服务、尚未到完成时间的请求（按完成时间排序）
+
+    long long nextId = 1;
+    int head = 0;        // 磁头所在磁道
+    int direction = 1;   // SCAN/LOOK 的扫描方向
+    double busyUntil = 0;
+
+    // 统计
+    long long completed = 0;
+    long long headTravel = 0; // 磁道数
+    double busyTime = 0;
+    double serviceSum = 0;
+    double firstArrival = -1;
+    double lastFinish = 0;
+    std::vector<double> responses;
+};
+
+#endif
@@ -0,0 +1,89 @@
+#include "extent_map.h"
+#include <algorithm>
+
+int ExtentMap::physicalBlock(int logical) const {
+    if (logical < 0 || logical >= blocks) return -1;
+
+    // 顺序访问：大多数时候还在上一次的段里或紧接着的下一段
+    for (std::size_t i = hint; i < list.size() && i < hint + 2; ++i) {
+        const Extent& e = list[i];
+        if (logical >= e.logical && logical < e.logical + e.count) {
+            hint = i;
+            return e.start + (logical - e.logical);
+        }
+    }
+
+    auto it = std::upper_bound(list.begin(), list.end(), logical,
+                               [](int l, const Extent& e) { return l < e.logical; });
+    --it;
+    hint = static_cast<std::size_t>(it - list.begin());
+    return it->start + (logical - it->logical);
+}
+
+int ExtentMap::lastPhysical() const {
+    if (list.empty()) return -1;
+    const Extent& e = list.back();
+    return e.start + e.count - 1;
+}
+
+void ExtentMap::append(int start, int count) {
+    if (count <= 0) return;
+    if (!list.empty() && list.back().start + list.back().count == start) {
+        list.back().count += count;
+    } else {
+        list.push_back(Extent{blocks, start, count});
+    }
+    blocks += count;
+}
+
+void ExtentMap::remap(int logical, int phys) {
+    if (logical < 0 || logical >= blocks) return;
+    auto it = std::upper_bound(list.begin(), list.end(), logical,
+                               [](int l, const Extent& e) { return l < e.logical; });
+    std::size_t i = static_cast<std::size_t>(it - list.begin()) - 1;
+    Extent e = list[i];
+    int before = logical - e.logical;
+    int after = e.count - before - 1;
+
+    // 原段拆成 [前半][新块][后半]，空的部分不要
+    std::vector<Extent> parts;
+    if (before > 0) parts.push_back(Extent{e.logical, e.start, before});
+    parts.push_back(Extent{logical, phys, 1});
+    if (after > 0) parts.push_back(Extent{logical + 1, e.start + before + 1, after});
+    list.erase(list.begin() + static_cast<std::ptrdiff_t>(i));
+    list.insert(list.begin() + static_cast<std::ptrdiff_t>(i), parts.begin(), parts.end());
+
+    // 新块与前后段物理相邻时合并（连续写时复制的块常常分到连续的新块）
+    std::size_t lo = i > 0 ? i - 1 : 0;
+    std::size_t hi = std::min(list.size() - 1, i + parts.size());
+    for (std::size_t k = hi; k > lo; --k) {
+        Extent& prev = list[k - 1];
+        const Extent& cur = list[k];
+        if (prev.start + prev.count == cur.start && prev.logical + prev.count == cur.logical) {
+            prev.count += cur.count;
+            list.erase(list.begin() + static_cast<std::ptrdiff_t>(k));
+        }
+    }
+    hint = 0;
+}
+
+std::vector<std::pair<int, int>> ExtentMap::truncate(int newCount) {
+    std::vector<std::pair<int, int>> freed;
+    if (newCount < 0) newCount = 0;
+    while (!list.empty() && blocks > newCount) {
+        Extent& e = list.back();
+        int drop = std::min(e.count, blocks - newCount);
+        freed.emplace_back(e.start + e.count - drop, drop);
+        e.count -= drop;
+        blocks -= drop;
+        if (e.count == 0) list.pop_back();
+    }
+    hint = 0;
+    return freed;
+}
+
+void ExtentMap::clear() {
+    list.clear();
+    blocks = 0;
+    hint = 0;
+}
@@ -0,0 +1,41 @@
+// storage/extent_map.h
+#ifndef EXTENT_MAP_H
+#define EXTENT_MAP_H
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+// inode 的块映射：文件逻辑块号 -> 物理块号，用连续段 (extent) 表示
+// 连续分配的文件只有少数几段，查找按逻辑块号二分，顺序访问时直接命中上一次的段。
+class ExtentMap {
+public:
+    struct Extent {
+        int logical; // 段内第一个逻辑块号
+        int start;   // 对应的物理块号
+        int count;
+    };
+
+    int blockCount() const { return blocks; }
+    // 逻辑块 -> 物理块，越界返回 -1
+    int physicalBlock(int logical) const;
+    // 最后一个逻辑块对应的物理块（文件增长时优先紧接其后分配），空映射返回 -1
+    int lastPhysical() const;
+
+    // 在文件末尾追加一段物理块，与最后一段物理相邻时直接合并
+    void append(int start, int count);
+    // 把逻辑块 logical 改映射到物理块 phys（写时复制），必要时拆分所在的段
+    void remap(int logical, int phys);
+    // 截断到 newCount 个块，返回被释放的物理段 (起始, 块数)
+    std::vector<std::pair<int, int>> truncate(int newCount);
+    void clear();
+
+    const std::vector<Extent>& extents() const { return list; }
+
+private:
+    std::vector<Extent> list;
+    int blocks = 0;
+    mutable std::size_t hint = 0; // 上一次查找命中的段
+};
+
+#endif
@@ -0,0 +1,108 @@
+#include "refcount_map.h"
+#include <algorithm>
+#include <iterator>
+
+void RefcountMap::split(int pos) {
+    auto it = segments.upper_bound(pos);
+    if (it == segments.begin()) return;
+    --it;
+    if (it->first == pos || it->second.end <= pos) return;
+    Segment tail{it->second.end, it->second.count};
+    it->second.end = pos;
+    segments.emplace(pos, tail);
+}
+
+void RefcountMap::mergeWithPrev(std::map<int, Segment>::iterator it) {
+    if (it == segments.end() || it == segments.begin()) return;
+    auto prev = std::prev(it);
+    if (prev->second.end == it->first && prev->second.count == it->second.count) {
+        prev->second.end = it->second.end;
+        segments.erase(it);
+    }
+}
+
+void RefcountMap::add(int start, int len, int delta, std::vector<Extent>* freed) {
+    if (len <= 0 || delta == 0) return;
+    const int end = start + len;
+    split(start);
+    split(end);
+
+    // 逐段更新；区间里没有段的空隙只在加引用时补上
+    int pos = start;
+    auto it = segments.lower_bound(start);
+    while (pos < end) {
+        if (it == segments.end() || it->first > pos) {
+            int gapEnd = (it == segments.end()) ? end : std::min(end, it->first);
+            if (delta > 0) segments.emplace(pos, Segment{gapEnd, delta});
+            pos = gapEnd;
+            continue;
+        }
+        it->second.count += delta;
+        pos = it->second.end;
+        if (it->second.count <= 0) {
+            if (freed) {
+                if (!freed->empty() && freed->back().first + freed->back().second == it->first) {
+                    freed->back().second += it->second.end - it->first;
+                } else {
+                    freed->emplace_back(it->first, it->second.end - it->first);
+                }
+            }
+            it = segments.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // 合并区间内部及两端计数相同的相邻段
+    auto first = segments.lower_bound(start);
+    if (first != segments.begin()) first = std::prev(first);
+    auto last = segments.upper_bound(end);
+    for (auto cur = first; cur != last && cur != segments.end();) {
+        auto next = std::next(cur);
+        mergeWithPrev(cur);
+        cur = next;
+    }
+}
+
+int RefcountMap::get(int block) const {
+    auto it = segments.upper_bound(block);
+    if (it == segments.begin()) return 0;
+    --it;
+    return block < it->second.end ? it->second.count : 0;
+}
+
+int RefcountMap::countIn(int start, int len, bool shared) const {
+    const int end = start + len;
+    int n = 0;
+    auto it = segments.upper_bound(start);
+    if (it != segments.begin()) --it;
+    for (; it != segments.end() && it->first < end; ++it) {
+        bool match = shared ? it->second.count > 1 : it->second.count == 1;
+        if (!match) continue;
+        n += std::max(0, std::min(end, it->second.end) - std::max(start, it->first));
+    }
+    return n;
+}
+
+int RefcountMap::sharedIn(int start, int len) const { return countIn(start, len, true); }
+int RefcountMap::exclusiveIn(int start, int len) const { return countIn(start, len, false); }
+
+long long RefcountMap::referencedBlocks() const {
+    long long n = 0;
+    for (const auto& seg : segments) n += seg.second.end - seg.first;
+    return n;
+}
+
+long long RefcountMap::totalReferences() const {
+    long long n = 0;
+    for (const auto& seg : segments) n += static_cast<long long>(seg.second.end - seg.first) * seg.second.count;
+    return n;
+}
+
+long long RefcountMap::sharedBlocks() const {
+    long long n = 0;
+    for (const auto& seg : segments) {
+        if (seg.second.count > 1) n += seg.second.end - seg.first;
+    }
+    return n;
+}
@@ -0,0 +1,45 @@
+// storage/refcount_map.h
+#ifndef REFCOUNT_MAP_H
+#define REFCOUNT_MAP_H
+
+#include <map>
+#include <vector>
+#include <utility>
+
+// 块引用计数，按区间存放：相邻且计数相同的块合并成一段，未出现的块计数为 0。
+// 文件的块大多连续，整个文件系统通常只有少数几段，给一个连续段加减引用是 O(log n)，
+// 因此快照只需按文件的连续段各加一次引用，代价与元数据量成正比而与数据量无关。
+class RefcountMap {
+public:
+    using Extent = std::pair<int, int>; // (起始块, 块数)
+
+    // [start, start+len) 的引用计数加 delta；计数降到 0 的区间追加到 freed（调用者负责释放这些块）
+    void add(int start, int len, int delta, std::vector<Extent>* freed = nullptr);
+    int get(int block) const;
+    void clear() { segments.clear(); }
+
+    // 统计（遍历所有区间）：被引用的块数、引用总数、被多方共享的块数
+    long long referencedBlocks() const;
+    long long totalReferences() const;
+    long long sharedBlocks() const;
+    // [start, start+len) 中计数大于 1 的块数
+    int sharedIn(int start, int len) const;
+    // [start, start+len) 中计数恰为 1 的块数
+    int exclusiveIn(int start, int len) const;
+    std::size_t intervals() const { return segments.size(); }
+
+private:
+    struct Segment {
+        int end;   // 不含
+        int count;
+    };
+    // 保证 pos 是某段的起点（若 pos 落在段内则把该段一分为二）
+    void split(int pos);
+    // 与前一段首尾相接且计数相同时合并
+    void mergeWithPrev(std::map<int, Segment>::iterator it);
+    int countIn(int start, int len, bool shared) const;
+
+    std::map<int, Segment> segments; // 起点 -> 段，互不重叠，计数均大于 0
+};
+
+#endif
@@ -1,182 +1,1217 @@
 #include "storage.h"
+#include "disk_format.h"
 #include <iomanip>
 #include <cstring> // for memset
+#include <algorithm>
+#include <climits>
+#include <cstddef> // for offsetof
+#include <cctype>
+#include <cstdio>
 
-StorageManager::StorageManager(int capacity) : totalCapacity(capacity) {
-    // 初始化位图，全部空闲
-    for(int i=0; i<TOTAL_BLOCKS; ++i) blockBitmap[i] = false;
+StorageManager::StorageManager(long long capacity, const std::string& imagePath)
+    : totalCapacity(capacity),
+      blockBitmap(static_cast<int>(std::min<long long>(capacity / BLOCK_SIZE, INT_MAX))),
+      image(imagePath, blockBitmap.size(), BLOCK_SIZE),
+      cache(image, BLOCK_SIZE),
+      ioQueue(blockBitmap.size()) {
+    // 位图初始全部空闲
+    size_t blocks = static_cast<size_t>(blockBitmap.size());
+    blockChecksums.assign(blocks, 0);
+    blockDirty.assign(blocks, 0);
+    blockVerified.assign(blocks, 1);
+
+    FileNode& root = inodes[ROOT_INO];
+    root.ino = ROOT_INO;
+    root.isDir = true;
+    root.size = 0;
+    root.createdAt = 0;
 }
 
-// 【核心逻辑】尝试分配物理块
-bool StorageManager::allocateBlocks(int size, std::vector<int>& outBlocks) {
-    int blocksNeeded = std::ceil((double)size / BLOCK_SIZE);
-    std::vector<int> tempBlocks;
+/* ================= 目录与路径 ================= */
 
-    // 扫描位图寻找空闲块
-    for (int i = 0; i < TOTAL_BLOCKS; ++i) {
-        if (!blockBitmap[i]) {
-            tempBlocks.push_back(i);
-            if (tempBlocks.size() == blocksNeeded) break;
+std::string StorageManager::absolutePath(const std::string& path) const {
+    std::vector<std::string> parts;
+    std::string full = (!path.empty() && path[0] == '/') ? path : cwdPath + "/" + path;
+    size_t pos = 0;
+    while (pos <= full.size()) {
+        size_t next = full.find('/', pos);
+        if (next == std::string::npos) next = full.size();
+        std::string part = full.substr(pos, next - pos);
+        if (part == "..") {
+            if (!parts.empty()) parts.pop_back();
+        } else if (!part.empty() && part != ".") {
+            parts.push_back(part);
         }
+        pos = next + 1;
+    }
+    std::string out;
+    for (const std::string& part : parts) out += "/" + part;
+    return out.empty() ? "/" : out;
+}
+
+// 同一个节点只有一种规范路径，所以目录项缓存按它作键，删除时精确作废即可
+const FileNode* StorageManager::resolve(const std::string& path) const {
+    std::string abs = absolutePath(path);
+    if (abs == "/") return &inodes.at(ROOT_INO);
+    int cached = dentries.lookup(abs);
+    if (cached >= 0) return &inodes.at(cached);
+
+    const FileNode* node = &inodes.at(ROOT_INO);
+    for (size_t pos = 1; pos < abs.size();) {
+        size_t next = abs.find('/', pos);
+        if (next == std::string::npos) next = abs.size();
+        if (!node->isDir) return nullptr;
+        auto it = node->entries.find(abs.substr(pos, next - pos));
+        if (it == node->entries.end()) return nullptr;
+        node = &inodes.at(it->second);
+        pos = next + 1;
+    }
+    dentries.insert(abs, node->ino);
+    return node;
+}
+
+FileNode* StorageManager::resolve(const std::string& path) {
+    return const_cast<FileNode*>(static_cast<const StorageManager*>(this)->resolve(path));
+}
+
+const FileNode* StorageManager::findFile(const std::string& path) const {
+    const FileNode* node = resolve(path);
+    return node && !node->isDir ? node : nullptr;
+}
+
+FileNode* StorageManager::findFile(const std::string& path, bool report) {
+    FileNode* node = resolve(path);
+    if (node && !node->isDir) return node;
+    if (report) {
+        std::cout << "[Storage] Error: " << (node ? "'" + path + "' is a directory" : "File '" + path + "' not found")
+                  << ".\n";
     }
+    return nullptr;
+}
+
+std::string StorageManager::pathOf(const FileNode& node) const {
+    if (node.ino == ROOT_INO) return "/";
+    std::string path;
+    for (const FileNode* n = &node; n->ino != ROOT_INO; n = &inodes.at(n->parent)) path = "/" + n->fileName + path;
+    return path;
+}
 
-    if (tempBlocks.size() < blocksNeeded) {
-        return false; // 空间不足
+FileNode* StorageManager::prepareCreate(const std::string& path, std::string& name) {
+    std::string abs = absolutePath(path);
+    size_t slash = abs.rfind('/');
+    name = abs.substr(slash + 1);
+    if (name.empty() || name.size() >= static_cast<size_t>(diskfmt::NAME_LEN)) {
+        std::cout << "[Storage] Error: Name must be 1-" << diskfmt::NAME_LEN - 1 << " characters.\n";
+        return nullptr;
+    }
+    FileNode* dir = resolve(slash == 0 ? "/" : abs.substr(0, slash));
+    if (!dir || !dir->isDir) {
+        std::cout << "[Storage] Error: Directory '" << abs.substr(0, slash) << "' not found.\n";
+        return nullptr;
     }
+    if (dir->entries.count(name)) {
+        std::cout << "[Storage] Error: '" << abs << "' already exists.\n";
+        return nullptr;
+    }
+    return dir;
+}
+
+FileNode& StorageManager::addNode(FileNode& dir, const std::string& name, bool isDir) {
+    int ino = nextIno++;
+    FileNode& node = inodes[ino];
+    node.ino = ino;
+    node.parent = dir.ino;
+    node.isDir = isDir;
+    node.fileName = name;
+    node.size = 0;
+    node.createdAt = 0;
+    dir.entries[name] = ino;
+    markDirty(ino);
+    return node;
+}
 
-    // 真正分配
-    for (int blockIndex : tempBlocks) {
-        blockBitmap[blockIndex] = true; // 标记占用
+bool StorageManager::makeDirectory(const std::string& path) {
+    std::string name;
+    FileNode* dir = prepareCreate(path, name);
+    if (!dir) return false;
+    FileNode& node = addNode(*dir, name, true);
+    std::cout << "[Storage] Directory '" << pathOf(node) << "' created.\n";
+    return true;
+}
+
+bool StorageManager::changeDirectory(const std::string& path) {
+    const FileNode* node = resolve(path);
+    if (!node || !node->isDir) {
+        std::cout << "[Storage] Error: Directory '" << path << "' not found.\n";
+        return false;
     }
-    outBlocks = tempBlocks;
+    cwdIno = node->ino;
+    cwdPath = pathOf(*node);
     return true;
 }
 
-// 【核心逻辑】释放物理块
-void StorageManager::freeBlocks(const std::vector<int>& blocks) {
-    for (int blockIndex : blocks) {
-        if (blockIndex >= 0 && blockIndex < TOTAL_BLOCKS) {
-            blockBitmap[blockIndex] = false; // 标记为空闲
+std::string printableBytes(const std::string& data) {
+    std::string out;
+    for (unsigned char c : data) {
+        if (std::isprint(c)) {
+            out += static_cast<char>(c);
+        } else {
+            char hex[5];
+            std::snprintf(hex, sizeof(hex), "\\x%02x", c);
+            out += hex;
         }
     }
+    return out;
+}
+
+// 块映射按物理连续段显示，例如 "0-3 8 10-11"
+static std::string formatBlocks(const ExtentMap& map) {
+    std::string out;
+    for (const ExtentMap::Extent& e : map.extents()) {
+        if (!out.empty()) out += " ";
+        out += std::to_string(e.start);
+        if (e.count > 1) out += "-" + std::to_string(e.start + e.count - 1);
+    }
+    return out;
+}
+
+// 【核心逻辑】文件增长：先尽量紧接最后一段向后扩展，不够的部分再整段连续分配
+bool StorageManager::growBlocks(FileNode& node, int blockCount) {
+    int need = blockCount - node.blocks.blockCount();
+    if (need <= 0) return true;
+    if (need > blockBitmap.freeCount()) return false; // 空间不足
+
+    std::vector<BlockBitmap::Extent> extents;
+    int next = node.blocks.lastPhysical() + 1;
+    if (next > 0 && next < blockBitmap.size() && !blockBitmap.test(next)) {
+        int run = std::min(need, blockBitmap.nextUsed(next) - next);
+        blockBitmap.markUsed(next, run);
+        extents.emplace_back(next, run);
+        need -= run;
+    }
+    std::vector<BlockBitmap::Extent> rest;
+    blockBitmap.allocate(need, rest);
+    extents.insert(extents.end(), rest.begin(), rest.end());
+
+    for (const auto& ext : extents) {
+        node.blocks.append(ext.first, ext.second);
+        refs.add(ext.first, ext.second, 1);
+        for (int b = ext.first; b < ext.first + ext.second; ++b) {
+            // 新分配的块内容无意义：不需要校验，但下次保存要为它记录校验和
+            blockVerified[static_cast<size_t>(b)] = 1;
+            if (!blockDirty[static_cast<size_t>(b)]) {
+                blockDirty[static_cast<size_t>(b)] = 1;
+                dirtyBlockList.push_back(b);
+            }
+        }
+    }
+    return true;
+}
+
+// 【核心逻辑】文件缩小：尾部的段减一次引用，不再被任何快照引用的块清位，缓存中的块直接丢弃
+void StorageManager::shrinkBlocks(FileNode& node, int blockCount) {
+    for (const auto& ext : node.blocks.truncate(blockCount)) dropRefs(ext.first, ext.second);
+}
+
+void StorageManager::dropRefs(int start, int count) {
+    std::vector<RefcountMap::Extent> freed;
+    refs.add(start, count, -1, &freed);
+    for (const auto& ext : freed) {
+        blockBitmap.markFree(ext.first, ext.second);
+        for (int b = ext.first; b < ext.first + ext.second; ++b) cache.invalidate(b);
+    }
+}
+
+bool StorageManager::resizeFile(FileNode& node, int newSize) {
+    if (newSize < 0 || newSize > maxFileSize()) return false;
+    int blockCount = blocksFor(newSize);
+    if (blockCount > node.blocks.blockCount()) {
+        if (!growBlocks(node, blockCount)) return false;
+    } else {
+        shrinkBlocks(node, blockCount);
+    }
+    node.size = newSize;
+    node.length = std::min(node.length, newSize);
+    node.lastReadBlock = -1;
+    node.readaheadUpTo = -1;
+    markDirty(node.ino);
+    return true;
 }
 
 bool StorageManager::createFile(const std::string& name, int size) {
-    if (fileSystem.find(name) != fileSystem.end()) {
-        std::cout << "[Storage] Error: File '" << name << "' already exists.\n";
+    if (size < 0) {
+        std::cout << "[Storage] Error: File size must not be negative.\n";
         return false;
     }
-    
-    // 尝试分配块
-    std::vector<int> blocks;
-    if (!allocateBlocks(size, blocks)) {
+    if (size > maxFileSize()) {
+        std::cout << "[Storage] Error: File size exceeds the disk capacity (" << maxFileSize() << " bytes).\n";
+        return false;
+    }
+    int blockCount = blocksFor(size);
+    if (blockCount > blockBitmap.freeCount()) {
         std::cout << "[Storage] Error: Not enough disk blocks.\n";
         return false;
     }
+    std::string entryName;
+    FileNode* dir = prepareCreate(name, entryName);
+    if (!dir) return false;
 
-    FileNode newNode;
-    newNode.fileName = name;
-    newNode.size = size;
-    newNode.content = ""; 
-    newNode.createdAt = 0;
-    newNode.blockIndices = blocks; // 记录占用的块
-    
-    fileSystem[name] = newNode;
+    // 尝试分配块（空间已检查过，不会失败）
+    FileNode& node = addNode(*dir, entryName, false);
+    growBlocks(node, blockCount);
+    node.size = size;
     
-    std::cout << "[Storage] File '" << name << "' created. Allocated " 
-              << blocks.size() << " blocks (Indices: ";
-    for(int b : blocks) std::cout << b << " ";
-    std::cout << ").\n";
+    std::cout << "[Storage] File '" << pathOf(node) << "' created. Allocated " 
+              << node.blocks.blockCount() << " blocks (Indices: " << formatBlocks(node.blocks) << ").\n";
     
     return true;
 }
 
+// 删除文件或空目录
 bool StorageManager::deleteFile(const std::string& name) {
-    auto it = fileSystem.find(name);
-    if (it != fileSystem.end()) {
-        // 释放块
-        freeBlocks(it->second.blockIndices);
-        fileSystem.erase(it);
-        std::cout << "[Storage] File '" << name << "' deleted & blocks freed.\n";
-        return true;
+    FileNode* node = resolve(name);
+    if (!node) {
+        std::cout << "[Storage] Error: File '" << name << "' not found.\n";
+        return false;
+    }
+    if (node->ino == ROOT_INO || node->ino == cwdIno) {
+        std::cout << "[Storage] Error: Cannot remove '" << name << "' (root or current directory).\n";
+        return false;
+    }
+    if (node->isDir && !node->entries.empty()) {
+        std::cout << "[Storage] Error: Directory '" << name << "' is not empty.\n";
+        return false;
     }
-    std::cout << "[Storage] Error: File '" << name << "' not found.\n";
-    return false;
+
+    std::string path = pathOf(*node);
+    // 释放块
+    shrinkBlocks(*node, 0);
+    releasedSlots.insert(releasedSlots.end(), node->slots.begin(), node->slots.end());
+    dirtyFiles.erase(node->ino);
+    dentries.invalidate(path);
+    inodes.at(node->parent).entries.erase(node->fileName);
+    inodes.erase(node->ino);
+    std::cout << "[Storage] '" << path << "' deleted & blocks freed.\n";
+    return true;
 }
 
 bool StorageManager::writeFile(const std::string& name, const std::string& content) {
-    if (fileSystem.find(name) == fileSystem.end()) {
-        std::cout << "[Storage] Error: File '" << name << "' not found.\n";
-        return false;
+    FileNode* node = findFile(name, true);
+    if (!node) return false;
+
+    // 整体覆盖：先写新内容（需要时增长），再截掉旧内容多出的部分
+    if (pwrite(name, 0, content.data(), static_cast<int>(content.length())) < 0) return false;
+    if (node->size != static_cast<int>(content.length())) resizeFile(*node, static_cast<int>(content.length()));
+    std::cout << "[Storage] Wrote " << content.length() << " bytes to '" << name << "'.\n";
+    return true;
+}
+
+int StorageManager::pread(const std::string& name, int offset, char* out, int len) const {
+    const FileNode* file = findFile(name);
+    if (!file) return -1;
+    const FileNode& node = *file;
+    if (offset < 0 || len <= 0 || offset >= node.size) return 0;
+    int n = std::min(len, node.size - offset);
+
+    // 有效长度以外的字节读出为零（块可能残留已删除文件的旧数据）
+    int valid = std::max(0, std::min(n, node.length - offset));
+    if (valid > 0) copyOut(node, static_cast<size_t>(offset), out, static_cast<size_t>(valid));
+    std::memset(out + valid, 0, static_cast<size_t>(n - valid));
+    return n;
+}
+
+int StorageManager::pwrite(const std::string& name, int offset, const char* data, int len) {
+    FileNode* file = findFile(name, true);
+    if (!file) return -1;
+    FileNode& node = *file;
+    if (offset < 0 || len < 0) return -1;
+    if (static_cast<long long>(offset) + len > maxFileSize()) {
+        std::cout << "[Storage] Error: Writing " << len << " bytes at offset " << offset << " would exceed the disk capacity ("
+                  << maxFileSize() << " bytes).\n";
+        return -1;
     }
-    
-    FileNode& node = fileSystem[name];
-    if (content.length() > node.size) {
-        std::cout << "[Storage] Error: Content exceeds file size (" 
-                  << node.size << " bytes). Re-create file with larger size.\n";
-        return false;
+    int end = offset + len;
+    // 有快照时，写到共享块要先复制，新增块与复制块一起检查空间
+    int grow = std::max(0, blocksFor(end) - node.blocks.blockCount());
+    int start = std::min(offset, node.length);
+    int cow = cowBlocksNeeded(node, static_cast<size_t>(start), static_cast<size_t>(end - start));
+    if (grow + cow > blockBitmap.freeCount() || (end > node.size && !resizeFile(node, end))) {
+        std::cout << "[Storage] Error: Not enough disk blocks to write " << len << " bytes to '" << name
+                  << "' at offset " << offset << ".\n";
+        return -1;
+    }
+
+    // 跳过的区间先清零，之后它们会落在有效长度之内
+    if (offset > node.length) copyIn(node, static_cast<size_t>(node.length), nullptr, static_cast<size_t>(offset - node.length));
+    copyIn(node, static_cast<size_t>(offset), data, static_cast<size_t>(len));
+    if (end > node.length) {
+        node.length = end;
+        markDirty(node.ino);
     }
+    return len;
+}
 
-    node.content = content;
-    std::cout << "[Storage] Wrote to '" << name << "'.\n";
+bool StorageManager::truncate(const std::string& name, int newSize) {
+    FileNode* node = findFile(name, true);
+    if (!node) return false;
+    if (newSize < 0 || !resizeFile(*node, newSize)) {
+        std::cout << "[Storage] Error: Cannot resize '" << name << "' to " << newSize << " bytes.\n";
+        return false;
+    }
+    std::cout << "[Storage] '" << name << "' is now " << newSize << " bytes ("
+              << node->blocks.blockCount() << " blocks).\n";
     return true;
 }
 
 std::string StorageManager::readFile(const std::string& name) {
-    if (fileSystem.find(name) != fileSystem.end()) {
-        return fileSystem[name].content;
+    const FileNode* node = findFile(name);
+    if (!node) return "";
+    std::string content(static_cast<size_t>(node->size), '\0');
+    if (!content.empty()) pread(name, 0, &content[0], node->size);
+    return content;
+}
+
+// shared 为与快照共享的块数（没有快照时为 0，不显示）
+static void printEntry(const std::string& name, const FileNode& node, int shared) {
+    std::cout << std::left << std::setw(15) << (node.isDir ? name + "/" : name);
+    if (node.isDir) {
+        std::cout << std::setw(8) << "<DIR>" << node.entries.size() << " entries\n";
+    } else {
+        std::cout << std::setw(8) << node.size
+                  << std::setw(8) << node.blocks.blockCount()
+                  << "[ " << formatBlocks(node.blocks) << " ]";
+        if (shared > 0) std::cout << " (" << shared << " shared)";
+        std::cout << "\n";
     }
-    return "";
 }
 
-void StorageManager::listFiles() const {
-    std::cout << "\n--- File System (Block Size: " << BLOCK_SIZE << ") ---\n";
+void StorageManager::listFiles(const std::string& path) const {
+    const FileNode* node = resolve(path);
+    if (!node) {
+        std::cout << "[Storage] Error: '" << path << "' not found.\n";
+        return;
+    }
+    std::cout << "\n--- " << pathOf(*node) << " (Block Size: " << BLOCK_SIZE << ") ---\n";
     std::cout << std::left << std::setw(15) << "Name" 
               << std::setw(8) << "Size" 
               << std::setw(8) << "Blocks"
               << "Block Indices\n";
     std::cout << "--------------------------------------------------------\n";
-    for (const auto& pair : fileSystem) {
-        const auto& node = pair.second;
-        std::cout << std::left << std::setw(15) << pair.first 
-                  << std::setw(8) << node.size 
-                  << std::setw(8) << node.blockIndices.size() << "[ ";
-        for(int b : node.blockIndices) std::cout << b << " ";
-        std::cout << "]\n";
+    if (!node->isDir) {
+        printEntry(node->fileName, *node, sharedBlocksOf(*node));
+    } else {
+        // 按哈希表顺序边遍历边输出，百万级目录也不需要先排序或复制
+        for (const auto& entry : node->entries) {
+            const FileNode& child = inodes.at(entry.second);
+            printEntry(entry.first, child, sharedBlocksOf(child));
+        }
     }
     printDiskStatus();
 }
 
-int StorageManager::getFreeSpace() const {
-    int freeBlocks = 0;
-    for(int i=0; i<TOTAL_BLOCKS; ++i) if(!blockBitmap[i]) freeBlocks++;
-    return freeBlocks * BLOCK_SIZE;
+long long StorageManager::getFreeSpace() const {
+    return static_cast<long long>(blockBitmap.freeCount()) * BLOCK_SIZE;
 }
 
 int StorageManager::getFileSize(const std::string& name) const {
-    if (fileSystem.find(name) != fileSystem.end()) return fileSystem.at(name).size;
-    return -1;
+    const FileNode* node = findFile(name);
+    return node ? node->size : -1;
+}
+
+int StorageManager::getFileBlockCount(const std::string& name) const {
+    const FileNode* node = findFile(name);
+    return node ? node->blocks.blockCount() : -1;
+}
+
+int StorageManager::getPhysicalBlock(const std::string& name, int blockNo) const {
+    const FileNode* node = findFile(name);
+    return node ? node->blocks.physicalBlock(blockNo) : -1;
+}
+
+// 文件的第 i 个逻辑块经块映射找到镜像中的物理块
+void StorageManager::copyOut(const FileNode& node, size_t offset, char* out, size_t len) const {
+    while (len > 0) {
+        size_t inBlock = offset % BLOCK_SIZE;
+        size_t n = std::min(len, BLOCK_SIZE - inBlock);
+        int blockNo = static_cast<int>(offset / BLOCK_SIZE);
+        int phys = node.blocks.physicalBlock(blockNo);
+        verifyBlock(phys);
+        readahead(node, blockNo);
+        cache.read(phys, inBlock, out, n);
+        offset += n;
+        out += n;
+        len -= n;
+    }
+}
+
+void StorageManager::copyIn(FileNode& node, size_t offset, const char* data, size_t len) {
+    while (len > 0) {
+        size_t inBlock = offset % BLOCK_SIZE;
+        size_t n = std::min(len, BLOCK_SIZE - inBlock);
+        int logical = static_cast<int>(offset / BLOCK_SIZE);
+        int phys = node.blocks.physicalBlock(logical);
+        if (!snapshots.empty() && refs.get(phys) > 1) phys = copyOnWrite(node, logical, phys, n == BLOCK_SIZE);
+        if (!blockDirty[static_cast<size_t>(phys)]) {
+            blockDirty[static_cast<size_t>(phys)] = 1;
+            dirtyBlockList.push_back(phys);
+        }
+        blockVerified[static_cast<size_t>(phys)] = 1;
+        cache.write(phys, inBlock, data, n);
+        if (data) data += n;
+        offset += n;
+        len -= n;
+    }
+}
+
+// 有效长度以外的字节读出为零（块可能残留已删除文件的旧数据）
+bool StorageManager::readFileBlock(const std::string& name, int blockNo, char* buf) const {
+    const FileNode* file = findFile(name);
+    int phys = file ? file->blocks.physicalBlock(blockNo) : -1;
+    if (phys < 0) return false;
+    const FileNode& node = *file;
+    int offset = blockNo * BLOCK_SIZE;
+    int valid = std::max(0, std::min(BLOCK_SIZE, node.length - offset));
+    verifyBlock(phys);
+    readahead(node, blockNo);
+    cache.read(phys, 0, buf, static_cast<size_t>(valid));
+    std::memset(buf + valid, 0, static_cast<size_t>(BLOCK_SIZE - valid));
+    return true;
+}
+
+bool StorageManager::writeFileBlock(const std::string& name, int blockNo, const char* buf) {
+    FileNode* file = findFile(name, false);
+    if (!file || file->blocks.physicalBlock(blockNo) < 0) return false;
+    FileNode& node = *file;
+    int offset = blockNo * BLOCK_SIZE;
+    // 写回不能超过文件大小
+    int len = std::min(BLOCK_SIZE, node.size - offset);
+    int start = std::min(offset, node.length);
+    if (cowBlocksNeeded(node, static_cast<size_t>(start), static_cast<size_t>(offset + len - start)) > blockBitmap.freeCount()) {
+        std::cout << "[Storage] Error: Not enough disk blocks to copy shared block " << blockNo << " of '" << name << "'.\n";
+        return false;
+    }
+    // 跳过的区间先清零，之后它们会落在有效长度之内
+    if (offset > node.length) copyIn(node, static_cast<size_t>(node.length), nullptr, static_cast<size_t>(offset - node.length));
+    copyIn(node, static_cast<size_t>(offset), buf, static_cast<size_t>(len));
+    if (offset + len > node.length) {
+        node.length = offset + len;
+        markDirty(node.ino);
+    }
+    return true;
+}
+
+int StorageManager::submitIo(const std::string& owner, const std::string& path, int offset, int len, bool write, double now) {
+    const FileNode* node = findFile(path);
+    if (!node) return -1;
+    int first = std::max(offset, 0) / BLOCK_SIZE;
+    long long end = static_cast<long long>(std::max(offset, 0)) + std::max(len, 1);
+    int last = static_cast<int>(std::min<long long>((end - 1) / BLOCK_SIZE, node->blocks.blockCount() - 1));
+    int requests = 0;
+    // 物理上连续的块合成一个请求
+    for (int b = first; b <= last;) {
+        int phys = node->blocks.physicalBlock(b);
+        int run = 1;
+        while (b + run <= last && node->blocks.physicalBlock(b + run) == phys + run) run++;
+        ioQueue.submit(owner, phys, run, write, now);
+        requests++;
+        b += run;
+    }
+    return requests;
+}
+
+bool StorageManager::setIoScheduler(const std::string& algorithm) {
+    DiskScheduler::Algorithm algo;
+    if (!DiskScheduler::parseAlgorithm(algorithm, algo)) return false;
+    ioQueue.setAlgorithm(algo);
+    std::cout << "[Disk] I/O scheduler set to " << DiskScheduler::algorithmName(algo) << ".\n";
+    return true;
 }
 
 // 显示磁盘位图
 void StorageManager::printDiskStatus() const {
-    std::cout << "[Disk Bitmap] (0=Free, 1=Used): ";
-    for(int i=0; i<TOTAL_BLOCKS; ++i) {
-        std::cout << (blockBitmap[i] ? "1" : "0");
+    const int total = blockBitmap.size();
+    std::cout << "[Disk] Image: " << (image.getPath().empty() ? "anonymous" : image.getPath())
+              << (image.isMapped() ? " (mmap)" : " (memory)") << " | "
+              << total << " blocks, " << blockBitmap.usedCount() << " used, "
+              << blockBitmap.freeCount() << " free (" << getFreeSpace() << " bytes)\n";
+    if (total <= 256) {
+        // 小磁盘逐块显示位图
+        std::cout << "[Disk Bitmap] (0=Free, 1=Used): ";
+        for (int i = 0; i < total; ++i) std::cout << (blockBitmap.test(i) ? "1" : "0");
+    } else {
+        // 大磁盘只显示空闲段概况
+        std::vector<BlockBitmap::Extent> runs = blockBitmap.freeExtents();
+        int largest = 0;
+        for (const auto& run : runs) largest = std::max(largest, run.second);
+        std::cout << "[Disk Bitmap] Free extents: " << runs.size() << " | Largest: " << largest << " blocks";
+    }
+    if (!snapshots.empty()) {
+        // 共享率 = 引用总数 / 被引用的块数：没有共享时为 1，快照与当前树完全相同时为快照数 + 1
+        long long referenced = refs.referencedBlocks();
+        std::cout << "\n[Sharing] Snapshots: " << snapshots.size() << " | Shared blocks: " << refs.sharedBlocks()
+                  << "/" << referenced << " | Sharing ratio: " << std::fixed << std::setprecision(2)
+                  << (referenced > 0 ? static_cast<double>(refs.totalReferences()) / referenced : 1.0)
+                  << "x | COW copies: " << cowCopies;
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6);
     }
     std::cout << "\n--------------------------------------------------------\n";
 }
 
-void StorageManager::saveToDisk(const std::string& realFileName) const {
-    std::ofstream outFile(realFileName);
-    if (!outFile.is_open()) return;
-    // 简单保存：文件数量
-    outFile << fileSystem.size() << "\n";
-    for (const auto& pair : fileSystem) {
+/* ================= 写时复制快照 ================= */
+
+void StorageManager::addTreeRefs(const InodeTable& tree) {
+    for (const auto& pair : tree) {
+        for (const ExtentMap::Extent& e : pair.second.blocks.extents()) refs.add(e.start, e.count, 1);
+    }
+}
+
+void StorageManager::dropTreeRefs(const InodeTable& tree) {
+    for (const auto& pair : tree) {
+        for (const ExtentMap::Extent& e : pair.second.blocks.extents()) dropRefs(e.start, e.count);
+    }
+}
+
+int StorageManager::cowBlocksNeeded(const FileNode& node, size_t offset, size_t len) const {
+    if (snapshots.empty() || len == 0) return 0;
+    int first = static_cast<int>(offset / BLOCK_SIZE);
+    int last = std::min(static_cast<int>((offset + len - 1) / BLOCK_SIZE), node.blocks.blockCount() - 1);
+    int needed = 0;
+    for (const ExtentMap::Extent& e : node.blocks.extents()) {
+        int lo = std::max(first, e.logical);
+        int hi = std::min(last, e.logical + e.count - 1);
+        if (lo <= hi) needed += refs.sharedIn(e.start + lo - e.logical, hi - lo + 1);
+    }
+    return needed;
+}
+
+// 【核心逻辑】写时复制：空间已由调用者检查过。新块紧接前一个逻辑块分配，
+// 顺序改写一段共享区时新块仍然连续，块映射里只多出一段
+int StorageManager::copyOnWrite(FileNode& node, int logical, int phys, bool whole) {
+    int hint = logical > 0 ? node.blocks.physicalBlock(logical - 1) + 1 : phys + 1;
+    int fresh = hint < blockBitmap.size() ? blockBitmap.nextFree(hint) : blockBitmap.size();
+    if (fresh >= blockBitmap.size()) fresh = blockBitmap.nextFree(0);
+    blockBitmap.markUsed(fresh, 1);
+    refs.add(fresh, 1, 1);
+    refs.add(phys, 1, -1); // 原块仍被快照引用，计数不会降到 0
+
+    if (!whole) {
+        char buf[BLOCK_SIZE];
+        verifyBlock(phys);
+        cache.read(phys, 0, buf, BLOCK_SIZE);
+        cache.write(fresh, 0, buf, BLOCK_SIZE);
+    }
+    blockVerified[static_cast<size_t>(fresh)] = 1;
+    if (!blockDirty[static_cast<size_t>(fresh)]) {
+        blockDirty[static_cast<size_t>(fresh)] = 1;
+        dirtyBlockList.push_back(fresh);
+    }
+    node.blocks.remap(logical, fresh);
+    markDirty(node.ino);
+    cowCopies++;
+    return fresh;
+}
+
+int StorageManager::sharedBlocksOf(const FileNode& node) const {
+    if (snapshots.empty()) return 0;
+    int shared = 0;
+    for (const ExtentMap::Extent& e : node.blocks.extents()) shared += refs.sharedIn(e.start, e.count);
+    return shared;
+}
+
+std::vector<StorageManager::Snapshot>::iterator StorageManager::findSnapshot(const std::string& name) {
+    return std::find_if(snapshots.begin(), snapshots.end(), [&](const Snapshot& s) { return s.name == name; });
+}
+
+// 快照只复制元数据：inode 表副本 + 每个连续段一次引用计数，与文件数据量无关
+bool StorageManager::createSnapshot(const std::string& name) {
+    if (name.empty() || name.length() >= static_cast<size_t>(diskfmt::NAME_LEN)) {
+        std::cout << "[Storage] Error: Snapshot name must be 1-" << diskfmt::NAME_LEN - 1 << " characters.\n";
+        return false;
+    }
+    if (findSnapshot(name) != snapshots.end()) {
+        std::cout << "[Storage] Error: Snapshot '" << name << "' already exists.\n";
+        return false;
+    }
+    Snapshot snap;
+    snap.name = name;
+    snap.createdAt = clock;
+    snap.inodes = inodes;
+    size_t extents = 0;
+    for (auto& pair : snap.inodes) {
+        FileNode& node = pair.second;
+        node.slots.clear();
+        node.lastReadBlock = -1;
+        node.readaheadUpTo = -1;
+        extents += node.blocks.extents().size();
+    }
+    addTreeRefs(snap.inodes);
+    snapshots.push_back(std::move(snap));
+    std::cout << "[Storage] Snapshot '" << name << "' created at time " << clock << ": " << inodes.size() - 1
+              << " file(s)/dir(s), " << extents << " extent(s) shared, no data copied.\n";
+    return true;
+}
+
+bool StorageManager::deleteSnapshot(const std::string& name) {
+    auto it = findSnapshot(name);
+    if (it == snapshots.end()) {
+        std::cout << "[Storage] Error: Snapshot '" << name << "' not found.\n";
+        return false;
+    }
+    int freeBefore = blockBitmap.freeCount();
+    dropTreeRefs(it->inodes);
+    releaseTreeSlots(it->inodes);
+    if (it->slot >= 0) releasedSlots.push_back(it->slot);
+    snapshots.erase(it);
+    std::cout << "[Storage] Snapshot '" << name << "' deleted, " << blockBitmap.freeCount() - freeBefore
+              << " block(s) freed.\n";
+    return true;
+}
+
+// 回滚：当前树的块减引用（只被当前树引用的块被释放），再换成快照的副本。快照本身保留，可以再次回滚
+bool StorageManager::rollbackSnapshot(const std::string& name) {
+    auto it = findSnapshot(name);
+    if (it == snapshots.end()) {
+        std::cout << "[Storage] Error: Snapshot '" << name << "' not found.\n";
+        return false;
+    }
+    int freeBefore = blockBitmap.freeCount();
+    dropTreeRefs(inodes);
+    releaseTreeSlots(inodes);
+    inodes = it->inodes;
+    addTreeRefs(inodes);
+
+    // 整棵树都要重新分配记录并写出
+    dirtyFiles.clear();
+    nextIno = ROOT_INO + 1;
+    for (auto& pair : inodes) {
+        pair.second.slots.clear();
+        nextIno = std::max(nextIno, pair.first + 1);
+        if (pair.first != ROOT_INO) markDirty(pair.first);
+    }
+    cwdIno = ROOT_INO;
+    cwdPath = "/";
+    dentries.clear();
+    std::cout << "[Storage] Rolled back to snapshot '" << name << "' (time " << it->createdAt << "): "
+              << inodes.size() - 1 << " file(s)/dir(s), " << blockBitmap.freeCount() - freeBefore
+              << " block(s) freed.\n";
+    return true;
+}
+
+void StorageManager::listSnapshots() const {
+    std::cout << "\n--- Snapshots (" << snapshots.size() << ") ---\n";
+    std::cout << std::left << std::setw(15) << "Name"
+              << std::setw(9) << "Created"
+              << std::setw(9) << "Entries"
+              << std::setw(9) << "Blocks"
+              << "Exclusive\n";
+    std::cout << "--------------------------------------------------------\n";
+    // Exclusive：只有这一方引用的块数，即删除该快照能释放的空间
+    auto printTree = [&](const std::string& name, int createdAt, const InodeTable& tree) {
+        long long blocks = 0;
+        long long exclusive = 0;
+        for (const auto& pair : tree) {
+            for (const ExtentMap::Extent& e : pair.second.blocks.extents()) {
+                blocks += e.count;
+                exclusive += refs.exclusiveIn(e.start, e.count);
+            }
+        }
+        std::cout << std::left << std::setw(15) << name
+                  << std::setw(9) << (createdAt < 0 ? std::string("-") : std::to_string(createdAt))
+                  << std::setw(9) << tree.size() - 1
+                  << std::setw(9) << blocks
+                  << exclusive << "\n";
+    };
+    for (const Snapshot& snap : snapshots) printTree(snap.name, snap.createdAt, snap.inodes);
+    printTree("(current)", -1, inodes);
+    printDiskStatus();
+}
+
+/* ================= 持久化 ================= */
+
+// 载入后第一次读到某块时才比对校验和
+void StorageManager::verifyBlock(int block) const {
+    size_t b = static_cast<size_t>(block);
+    if (blockVerified[b]) return;
+    blockVerified[b] = 1;
+    if (diskfmt::crc32(image.block(block), BLOCK_SIZE) != blockChecksums[b]) {
+        checksumErrors++;
+        std::cout << "[Storage] Warning: Checksum mismatch in block " << block << ", data may be corrupt.\n";
+    }
+}
+
+// 连续读到相邻逻辑块时，保持预读窗口领先当前块 READAHEAD_BLOCKS 块
+void StorageManager::readahead(const FileNode& node, int blockNo) const {
+    bool sequential = blockNo == node.lastReadBlock + 1;
+    node.lastReadBlock = blockNo;
+    if (!sequential) {
+        node.readaheadUpTo = blockNo; // 随机访问：窗口从这里重新开始
+        return;
+    }
+
+    // 窗口不超过缓存的一半，避免预读块把正在用的块挤出去
+    int window = std::min(READAHEAD_BLOCKS, cache.getCapacity() / 2);
+    int last = std::min(blockNo + window, node.blocks.blockCount() - 1);
+    for (int b = std::max(blockNo + 1, node.readaheadUpTo + 1); b <= last; ++b) {
+        cache.prefetch(node.blocks.physicalBlock(b));
+        node.readaheadUpTo = b;
+    }
+}
+
+int StorageManager::takeSlot() {
+    if (!freeSlots.empty()) {
+        int slot = freeSlots.back();
+        freeSlots.pop_back();
+        return slot;
+    }
+    return nextSlot++;
+}
+
+void StorageManager::releaseTreeSlots(const InodeTable& tree) {
+    for (const auto& pair : tree) {
+        releasedSlots.insert(releasedSlots.end(), pair.second.slots.begin(), pair.second.slots.end());
+    }
+}
+
+// 块映射 -> 元数据中的连续段记录
+static std::vector<diskfmt::ExtentRecord> toExtents(const ExtentMap& map) {
+    std::vector<diskfmt::ExtentRecord> extents;
+    for (const ExtentMap::Extent& e : map.extents()) extents.push_back({e.start, e.count});
+    return extents;
+}
+
+static size_t recordsNeeded(const FileNode& node) {
+    size_t extents = toExtents(node.blocks).size();
+    return std::max<size_t>(1, (extents + diskfmt::EXTENTS_PER_RECORD - 1) / diskfmt::EXTENTS_PER_RECORD);
+}
+
+// 把文件或目录编码为 node.slots.size() 条记录
+static std::vector<diskfmt::InodeRecord> buildRecords(const FileNode& node, int parentSlot) {
+    std::vector<diskfmt::ExtentRecord> extents = toExtents(node.blocks);
+    std::vector<diskfmt::InodeRecord> records(node.slots.size());
+    for (size_t r = 0; r < records.size(); ++r) {
+        diskfmt::InodeRecord& rec = records[r];
+        std::memset(&rec, 0, sizeof(rec));
+        rec.type = r > 0 ? diskfmt::RECORD_EXTENT : node.isDir ? diskfmt::RECORD_DIR : diskfmt::RECORD_INODE;
+        rec.next = r + 1 < records.size() ? node.slots[r + 1] : -1;
+        if (r == 0) {
+            rec.size = node.size;
+            rec.length = node.length;
+            rec.createdAt = node.createdAt;
+            rec.parent = parentSlot;
+            node.fileName.copy(rec.name, diskfmt::NAME_LEN - 1);
+        }
+        size_t first = r * diskfmt::EXTENTS_PER_RECORD;
+        for (size_t e = first; e < extents.size() && e < first + diskfmt::EXTENTS_PER_RECORD; ++e) {
+            rec.extents[rec.extentCount++] = extents[e];
+        }
+    }
+    return records;
+}
+
+// 快照树的记录：快照头 + 各节点，type 高位记着快照头的记录号。快照创建后不再改变，只需写一次
+std::vector<std::pair<int, diskfmt::InodeRecord>> StorageManager::snapshotRecords(Snapshot& snap) {
+    if (snap.slot < 0) snap.slot = takeSlot();
+    for (auto& pair : snap.inodes) {
+        FileNode& node = pair.second;
+        if (pair.first == ROOT_INO || !node.slots.empty()) continue;
+        node.slots.assign(recordsNeeded(node), 0);
+        for (int& slot : node.slots) slot = takeSlot();
+    }
+
+    std::vector<std::pair<int, diskfmt::InodeRecord>> out;
+    diskfmt::InodeRecord head;
+    std::memset(&head, 0, sizeof(head));
+    head.type = diskfmt::RECORD_SNAPSHOT;
+    head.next = -1;
+    head.createdAt = snap.createdAt;
+    head.parent = -1;
+    snap.name.copy(head.name, diskfmt::NAME_LEN - 1);
+    out.emplace_back(snap.slot, head);
+    for (const auto& pair : snap.inodes) {
+        if (pair.first == ROOT_INO) continue;
         const FileNode& node = pair.second;
-        // 格式：Name Size Content
-        outFile << node.fileName << " " << node.size << " " << (node.content.empty() ? "EMPTY" : node.content) << "\n";
+        std::vector<diskfmt::InodeRecord> records = buildRecords(node, parentSlot(snap.inodes, node));
+        for (size_t r = 0; r < records.size(); ++r) {
+            records[r].type = diskfmt::makeRecordType(records[r].type, snap.slot);
+            out.emplace_back(node.slots[r], records[r]);
+        }
     }
-    outFile.close();
+    snap.dirty = false;
+    return out;
 }
 
-void StorageManager::loadFromDisk(const std::string& realFileName) {
-    std::ifstream inFile(realFileName);
-    if (!inFile.is_open()) return;
-    
-    // 重置
-    fileSystem.clear();
-    for(int i=0; i<TOTAL_BLOCKS; ++i) blockBitmap[i] = false;
-
-    int count;
-    inFile >> count;
-    std::string name, content;
-    int size;
-    for (int i = 0; i < count; ++i) {
-        inFile >> name >> size >> content;
-        if(content == "EMPTY") content = "";
-        createFile(name, size); // 重新调用 create 以分配块
-        fileSystem[name].content = content;
-    }
-    inFile.close();
-}
\ No newline at end of file
+struct MetaLayout {
+    std::uint64_t inodeOffset;
+    std::uint64_t bitmapOffset;
+    std::uint64_t checksumOffset;
+};
+
+static MetaLayout layoutFor(int inodeSlots, int blocks) {
+    MetaLayout l;
+    l.inodeOffset = sizeof(diskfmt::Superblock);
+    l.bitmapOffset = l.inodeOffset + static_cast<std::uint64_t>(inodeSlots) * sizeof(diskfmt::InodeRecord);
+    l.checksumOffset = l.bitmapOffset + static_cast<std::uint64_t>((blocks + 63) / 64) * sizeof(std::uint64_t);
+    return l;
+}
+
+static void writeSuperblock(std::fstream& out, int inodeSlots, int blocks, std::uint32_t generation) {
+    MetaLayout l = layoutFor(inodeSlots, blocks);
+    diskfmt::Superblock sb;
+    std::memset(&sb, 0, sizeof(sb));
+    std::memcpy(sb.magic, diskfmt::MAGIC, sizeof(sb.magic));
+    sb.version = diskfmt::VERSION;
+    sb.blockSize = BLOCK_SIZE;
+    sb.totalBlocks = static_cast<std::uint32_t>(blocks);
+    sb.inodeSlots = static_cast<std::uint32_t>(inodeSlots);
+    sb.generation = generation;
+    sb.inodeOffset = l.inodeOffset;
+    sb.bitmapOffset = l.bitmapOffset;
+    sb.checksumOffset = l.checksumOffset;
+    sb.checksum = diskfmt::crc32(&sb, offsetof(diskfmt::Superblock, checksum));
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&sb), sizeof(sb));
+}
+
+// 全量保存：重新紧凑分配 inode 记录，inode 表留出一倍余量供后续增量保存
+bool StorageManager::saveFull(const std::string& realFileName) {
+    cache.flush(); // 校验和按镜像中的内容计算
+    size_t needed = 0;
+    for (const auto& pair : inodes) {
+        if (pair.first != ROOT_INO) needed += recordsNeeded(pair.second);
+    }
+    for (const Snapshot& snap : snapshots) {
+        needed++;
+        for (const auto& pair : snap.inodes) {
+            if (pair.first != ROOT_INO) needed += recordsNeeded(pair.second);
+        }
+    }
+    inodeSlots = diskfmt::MIN_INODE_SLOTS;
+    while (static_cast<size_t>(inodeSlots) < needed * 2) inodeSlots *= 2;
+
+    nextSlot = 0;
+    freeSlots.clear();
+    releasedSlots.clear();
+    std::vector<diskfmt::InodeRecord> table(static_cast<size_t>(inodeSlots));
+    std::memset(table.data(), 0, table.size() * sizeof(diskfmt::InodeRecord));
+    // 先给所有节点分配记录，子节点才能引用父目录的记录号
+    for (auto& pair : inodes) {
+        if (pair.first == ROOT_INO) continue;
+        FileNode& node = pair.second;
+        node.slots.assign(recordsNeeded(node), 0);
+        for (int& slot : node.slots) slot = takeSlot();
+    }
+    for (const auto& pair : inodes) {
+        if (pair.first == ROOT_INO) continue;
+        const FileNode& node = pair.second;
+        std::vector<diskfmt::InodeRecord> records = buildRecords(node, parentSlot(inodes, node));
+        for (size_t r = 0; r < records.size(); ++r) table[static_cast<size_t>(node.slots[r])] = records[r];
+    }
+    for (Snapshot& snap : snapshots) {
+        snap.slot = -1;
+        for (auto& pair : snap.inodes) pair.second.slots.clear();
+        for (const auto& rec : snapshotRecords(snap)) table[static_cast<size_t>(rec.first)] = rec.second;
+    }
+
+    int blocks = blockBitmap.size();
+    for (int b = 0; b < blocks; ++b) {
+        blockChecksums[static_cast<size_t>(b)] = blockBitmap.test(b) ? diskfmt::crc32(image.block(b), BLOCK_SIZE) : 0;
+    }
+
+    std::fstream out(realFileName, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cout << "[Storage] Error: Cannot write '" << realFileName << "'.\n";
+        return false;
+    }
+    generation++;
+    writeSuperblock(out, inodeSlots, blocks, generation);
+    out.write(reinterpret_cast<const char*>(table.data()), static_cast<std::streamsize>(table.size() * sizeof(diskfmt::InodeRecord)));
+    const std::vector<std::uint64_t>& words = blockBitmap.getWords();
+    out.write(reinterpret_cast<const char*>(words.data()), static_cast<std::streamsize>(words.size() * sizeof(std::uint64_t)));
+    out.write(reinterpret_cast<const char*>(blockChecksums.data()), static_cast<std::streamsize>(blockChecksums.size() * sizeof(std::uint32_t)));
+    out.flush();
+    image.sync();
+
+    persistedPath = realFileName;
+    persistedBitmap = words;
+    dirtyFiles.clear();
+    for (int b : dirtyBlockList) blockDirty[static_cast<size_t>(b)] = 0;
+    dirtyBlockList.clear();
+    std::cout << "[Storage] Saved to " << realFileName << " (full, generation " << generation << "): "
+              << inodes.size() - 1 << " file(s)/dir(s), " << snapshots.size() << " snapshot(s), "
+              << inodeSlots << " inode slot(s).\n";
+    return true;
+}
+
+bool StorageManager::saveToDisk(const std::string& realFileName) {
+    cache.flush();
+    std::fstream out;
+    if (realFileName == persistedPath) out.open(realFileName, std::ios::in | std::ios::out | std::ios::binary);
+    if (!out.is_open()) return saveFull(realFileName);
+
+    // 1. 脏文件的记录数可能变化（连续段增减），先调整占用的 inode 记录
+    for (int ino : dirtyFiles) {
+        FileNode& node = inodes.at(ino);
+        size_t need = recordsNeeded(node);
+        while (node.slots.size() < need) node.slots.push_back(takeSlot());
+        while (node.slots.size() > need) {
+            releasedSlots.push_back(node.slots.back());
+            node.slots.pop_back();
+        }
+    }
+    // 新建的快照整棵写出
+    std::vector<std::pair<int, diskfmt::InodeRecord>> snapshotRecs;
+    for (Snapshot& snap : snapshots) {
+        if (!snap.dirty) continue;
+        std::vector<std::pair<int, diskfmt::InodeRecord>> recs = snapshotRecords(snap);
+        snapshotRecs.insert(snapshotRecs.end(), recs.begin(), recs.end());
+    }
+    if (dirtyFiles.empty() && releasedSlots.empty() && dirtyBlockList.empty() && snapshotRecs.empty() &&
+        blockBitmap.getWords() == persistedBitmap) {
+        std::cout << "[Storage] " << realFileName << " is up to date.\n";
+        return true;
+    }
+    if (nextSlot > inodeSlots) {
+        out.close();
+        return saveFull(realFileName); // inode 表已满，重新布局
+    }
+
+    int blocks = blockBitmap.size();
+    MetaLayout l = layoutFor(inodeSlots, blocks);
+    int recordsWritten = 0;
+    int wordsWritten = 0;
+
+    // 2. 已删除文件的记录清零后才能重新分配
+    diskfmt::InodeRecord empty;
+    std::memset(&empty, 0, sizeof(empty));
+    for (int slot : releasedSlots) {
+        out.seekp(static_cast<std::streamoff>(l.inodeOffset + static_cast<std::uint64_t>(slot) * sizeof(empty)));
+        out.write(reinterpret_cast<const char*>(&empty), sizeof(empty));
+        freeSlots.push_back(slot);
+        recordsWritten++;
+    }
+    releasedSlots.clear();
+
+    // 3. 脏 inode
+    for (int ino : dirtyFiles) {
+        const FileNode& node = inodes.at(ino);
+        std::vector<diskfmt::InodeRecord> records = buildRecords(node, parentSlot(inodes, node));
+        for (size_t r = 0; r < records.size(); ++r) {
+            out.seekp(static_cast<std::streamoff>(l.inodeOffset + static_cast<std::uint64_t>(node.slots[r]) * sizeof(empty)));
+            out.write(reinterpret_cast<const char*>(&records[r]), sizeof(empty));
+            recordsWritten++;
+        }
+    }
+    for (const auto& rec : snapshotRecs) {
+        out.seekp(static_cast<std::streamoff>(l.inodeOffset + static_cast<std::uint64_t>(rec.first) * sizeof(empty)));
+        out.write(reinterpret_cast<const char*>(&rec.second), sizeof(empty));
+        recordsWritten++;
+    }
+
+    // 4. 只写与上次保存不同的位图字
+    const std::vector<std::uint64_t>& words = blockBitmap.getWords();
+    for (size_t i = 0; i < words.size(); ++i) {
+        if (words[i] == persistedBitmap[i]) continue;
+        out.seekp(static_cast<std::streamoff>(l.bitmapOffset + i * sizeof(std::uint64_t)));
+        out.write(reinterpret_cast<const char*>(&words[i]), sizeof(std::uint64_t));
+        wordsWritten++;
+    }
+
+    // 5. 被写过的块重新计算校验和
+    for (int b : dirtyBlockList) {
+        size_t idx = static_cast<size_t>(b);
+        blockChecksums[idx] = diskfmt::crc32(image.block(b), BLOCK_SIZE);
+        blockDirty[idx] = 0;
+        out.seekp(static_cast<std::streamoff>(l.checksumOffset + idx * sizeof(std::uint32_t)));
+        out.write(reinterpret_cast<const char*>(&blockChecksums[idx]), sizeof(std::uint32_t));
+    }
+    size_t blocksWritten = dirtyBlockList.size();
+
+    generation++;
+    writeSuperblock(out, inodeSlots, blocks, generation);
+    out.flush();
+    image.sync(); // 数据块本身在 mmap 镜像里，只需把脏页刷回
+    if (!out) {
+        std::cout << "[Storage] Error: Failed to write '" << realFileName << "'.\n";
+        return false;
+    }
+
+    persistedBitmap = words;
+    dirtyFiles.clear();
+    dirtyBlockList.clear();
+    std::cout << "[Storage] Saved to " << realFileName << " (incremental, generation " << generation << "): "
+              << recordsWritten << " inode record(s), " << wordsWritten << " bitmap word(s), "
+              << blocksWritten << " block checksum(s).\n";
+    return true;
+}
+
+// 重建目录项：父目录缺失或成环（元数据损坏）的节点挂到根目录下并计数，重名的改名保留
+int StorageManager::linkTree(InodeTable& tree, const std::unordered_map<int, int>& slotToIno, bool live) {
+    int repaired = 0;
+    auto repair = [&](FileNode& node) {
+        repaired++;
+        if (live) markDirty(node.ino);
+    };
+    for (auto& pair : tree) {
+        FileNode& node = pair.second;
+        if (node.ino == ROOT_INO) continue;
+        auto parent = slotToIno.find(node.parent);
+        bool valid = node.parent == -1 || (parent != slotToIno.end() && tree.at(parent->second).isDir);
+        node.parent = valid && node.parent != -1 ? parent->second : ROOT_INO;
+        if (!valid) repair(node);
+    }
+    for (auto& pair : tree) {
+        FileNode& node = pair.second;
+        size_t depth = 0;
+        for (int p = node.parent; p > ROOT_INO && depth <= tree.size(); p = tree.at(p).parent) depth++;
+        if (depth > tree.size()) {
+            node.parent = ROOT_INO;
+            repair(node);
+        }
+    }
+    for (auto& pair : tree) {
+        FileNode& node = pair.second;
+        if (node.ino == ROOT_INO) continue;
+        FileNode& dir = tree.at(node.parent);
+        if (!dir.entries.emplace(node.fileName, node.ino).second) {
+            node.fileName += "#" + std::to_string(node.ino);
+            dir.entries.emplace(node.fileName, node.ino);
+            if (live) markDirty(node.ino);
+        }
+    }
+    return repaired;
+}
+
+// 载入只读元数据：超级块、inode 表、位图与校验和各一次顺序读，不逐个重建文件
+bool StorageManager::loadFromDisk(const std::string& realFileName) {
+    std::ifstream in(realFileName, std::ios::binary);
+    if (!in.is_open()) return false;
+
+    diskfmt::Superblock sb;
+    in.read(reinterpret_cast<char*>(&sb), sizeof(sb));
+    if (!in || std::memcmp(sb.magic, diskfmt::MAGIC, sizeof(sb.magic)) != 0 ||
+        sb.version < diskfmt::MIN_VERSION || sb.version > diskfmt::VERSION ||
+        sb.checksum != diskfmt::crc32(&sb, offsetof(diskfmt::Superblock, checksum))) {
+        std::cout << "[Storage] Error: '" << realFileName << "' is not a valid disk metadata file.\n";
+        return false;
+    }
+    int blocks = blockBitmap.size();
+    if (sb.blockSize != static_cast<std::uint32_t>(BLOCK_SIZE) || sb.totalBlocks != static_cast<std::uint32_t>(blocks)) {
+        std::cout << "[Storage] Error: '" << realFileName << "' describes a " << sb.totalBlocks
+                  << "-block disk, current disk has " << blocks << " blocks.\n";
+        return false;
+    }
+
+    std::vector<diskfmt::InodeRecord> table(sb.inodeSlots);
+    std::vector<std::uint64_t> words(static_cast<size_t>((blocks + 63) / 64));
+    std::vector<std::uint32_t> sums(static_cast<size_t>(blocks));
+    in.seekg(static_cast<std::streamoff>(sb.inodeOffset));
+    in.read(reinterpret_cast<char*>(table.data()), static_cast<std::streamsize>(table.size() * sizeof(diskfmt::InodeRecord)));
+    in.seekg(static_cast<std::streamoff>(sb.bitmapOffset));
+    in.read(reinterpret_cast<char*>(words.data()), static_cast<std::streamsize>(words.size() * sizeof(std::uint64_t)));
+    in.seekg(static_cast<std::streamoff>(sb.checksumOffset));
+    in.read(reinterpret_cast<char*>(sums.data()), static_cast<std::streamsize>(sums.size() * sizeof(std::uint32_t)));
+    if (!in) {
+        std::cout << "[Storage] Error: '" << realFileName << "' is truncated.\n";
+        return false;
+    }
+
+    auto makeRoot = [](InodeTable& tree) {
+        FileNode& root = tree[ROOT_INO];
+        root.ino = ROOT_INO;
+        root.isDir = true;
+        root.size = 0;
+        root.createdAt = 0;
+    };
+    inodes.clear();
+    dirtyFiles.clear();
+    snapshots.clear();
+    refs.clear();
+    makeRoot(inodes);
+    freeSlots.clear();
+    releasedSlots.clear();
+    nextSlot = 0;
+
+    // 先找出快照头，每棵树（当前树 + 各快照）各自编号 inode、各自还原目录结构
+    std::unordered_map<int, size_t> snapshotAt; // 快照头记录号 -> 在 snapshots 中的下标
+    for (size_t i = 0; i < table.size(); ++i) {
+        if (diskfmt::recordKind(table[i].type) != diskfmt::RECORD_SNAPSHOT) continue;
+        Snapshot snap;
+        snap.name.assign(table[i].name, std::find(table[i].name, table[i].name + diskfmt::NAME_LEN, '\0'));
+        snap.createdAt = table[i].createdAt;
+        snap.slot = static_cast<int>(i);
+        snap.dirty = false;
+        makeRoot(snap.inodes);
+        snapshotAt[static_cast<int>(i)] = snapshots.size();
+        snapshots.push_back(std::move(snap));
+        nextSlot = std::max(nextSlot, static_cast<int>(i) + 1);
+    }
+    std::vector<std::unordered_map<int, int>> slotToIno(snapshots.size() + 1); // [0] 为当前树
+    for (size_t i = 0; i < table.size(); ++i) {
+        std::uint32_t type = diskfmt::recordKind(table[i].type);
+        if (type != diskfmt::RECORD_INODE && type != diskfmt::RECORD_DIR) continue;
+        int owner = diskfmt::recordOwner(table[i].type);
+        size_t tree = 0;
+        if (owner >= 0) {
+            auto snap = snapshotAt.find(owner);
+            if (snap == snapshotAt.end()) {
+                releasedSlots.push_back(static_cast<int>(i)); // 快照头已丢失，丢弃这条记录
+                continue;
+            }
+            tree = snap->second + 1;
+        }
+        InodeTable& nodes = tree == 0 ? inodes : snapshots[tree - 1].inodes;
+        const diskfmt::InodeRecord& inode = table[i];
+        int ino = static_cast<int>(nodes.size());
+        FileNode& node = nodes[ino];
+        node.ino = ino;
+        node.isDir = type == diskfmt::RECORD_DIR;
+        node.fileName.assign(inode.name, std::find(inode.name, inode.name + diskfmt::NAME_LEN, '\0'));
+        node.size = inode.size;
+        node.length = inode.length;
+        node.createdAt = inode.createdAt;
+        node.parent = inode.parent; // 暂存父目录的记录号，下面再换成 inode 号
+        slotToIno[tree][static_cast<int>(i)] = ino;
+        // 沿 next 链收集连续段（链长不会超过表的大小）
+        for (int slot = static_cast<int>(i); slot >= 0 && slot < static_cast<int>(table.size()) &&
+                                             node.slots.size() < table.size();
+             slot = table[static_cast<size_t>(slot)].next) {
+            const diskfmt::InodeRecord& rec = table[static_cast<size_t>(slot)];
+            node.slots.push_back(slot);
+            nextSlot = std::max(nextSlot, slot + 1);
+            for (std::uint32_t e = 0; e < rec.extentCount && e < static_cast<std::uint32_t>(diskfmt::EXTENTS_PER_RECORD); ++e) {
+                node.blocks.append(rec.extents[e].start, rec.extents[e].count);
+            }
+        }
+    }
+    nextIno = static_cast<int>(inodes.size());
+    int orphans = linkTree(inodes, slotToIno[0], true);
+    for (size_t k = 0; k < snapshots.size(); ++k) orphans += linkTree(snapshots[k].inodes, slotToIno[k + 1], false);
+
+    // 引用计数不持久化，由所有树的块映射重建
+    addTreeRefs(inodes);
+    for (const Snapshot& snap : snapshots) addTreeRefs(snap.inodes);
+
+    for (int slot = 0; slot < nextSlot; ++slot) {
+        if (table[static_cast<size_t>(slot)].type == diskfmt::RECORD_FREE) freeSlots.push_back(slot);
+    }
+
+    blockBitmap.loadWords(words);
+    blockChecksums = sums;
+    blockVerified.assign(static_cast<size_t>(blocks), 0);
+    blockDirty.assign(static_cast<size_t>(blocks), 0);
+    dirtyBlockList.clear();
+    inodeSlots = static_cast<int>(sb.inodeSlots);
+    cwdIno = ROOT_INO;
+    cwdPath = "/";
+    dentries.clear();
+    generation = sb.generation;
+    persistedPath = realFileName;
+    persistedBitmap = blockBitmap.getWords();
+
+    if (orphans > 0) std::cout << "[Storage] Warning: " << orphans << " entry(s) lost their directory, moved to /.\n";
+    std::cout << "[Storage] Loaded " << inodes.size() - 1 << " file(s)/dir(s)";
+    if (!snapshots.empty()) std::cout << " and " << snapshots.size() << " snapshot(s)";
+    std::cout << " from " << realFileName << " (generation " << generation << ").\n";
+    return true;
+}
@@ -3,55 +3,230 @@
 
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <iostream>
 #include <fstream>
 #include <cmath>
+#include <set>
+#include <cstdint>
+#include <climits>
+#include <algorithm>
+#include "block_bitmap.h"
+#include "disk_image.h"
+#include "buffer_cache.h"
+#include "extent_map.h"
+#include "dentry_cache.h"
+#include "disk_scheduler.h"
+#include "refcount_map.h"
+#include "disk_format.h"
 
 // 定义磁盘块大小（例如每块 32 字节）
 const int BLOCK_SIZE = 32;
-// 假设总容量 1024 字节 -> 32 个块
-const int TOTAL_BLOCKS = 1024 / BLOCK_SIZE;
 
+// 文件或目录的 inode：文件大小可变，读写按偏移进行；目录用哈希表索引目录项
 struct FileNode {
-    std::string fileName;
-    int size;
-    std::string content; // 实际内容（为了简化读写，仍然保留这个，但逻辑上它分散在 blockIndices 里）
+    int ino = -1;
+    int parent = -1;     // 所在目录的 inode 号，根目录为 -1
+    bool isDir = false;
+    std::string fileName; // 在所在目录中的名字
+    int size;            // 文件大小（字节），随写入增长、随截断缩小
+    int length = 0;      // 已写入的有效字节数，[length, size) 读出为零
     int createdAt;       
     
-    // 索引表：记录该文件占用了哪些物理块
-    std::vector<int> blockIndices; 
+    // 块映射：逻辑块 -> 物理块的连续段，块数 = ceil(size / BLOCK_SIZE)
+    ExtentMap blocks;
+
+    // 目录项：名字 -> inode 号（仅目录使用），查找平均 O(1)
+    std::unordered_map<std::string, int> entries;
+
+    // 在元数据文件 inode 表中占用的记录（第一条为 inode，其余为连续段续表）
+    std::vector<int> slots;
+
+    // 顺序读检测（不持久化）：上次读到的逻辑块、已预读到的逻辑块
+    mutable int lastReadBlock = -1;
+    mutable int readaheadUpTo = -1;
 };
 
+// 显示文件内容用：NUL（稀疏文件的空洞）等不可打印字节转义成 \xNN
+std::string printableBytes(const std::string& data);
+
 class StorageManager {
 public:
-    StorageManager(int capacity = 1024);
+    // 磁盘容量（字节）在运行时指定，块数 = capacity / BLOCK_SIZE；
+    // 文件内容存放在 imagePath 镜像文件的块中，imagePath 为空时存放在匿名内存里（退出即丢弃）
+    StorageManager(long long capacity = 1024, const std::string& imagePath = "os_disk.img");
+
+    // 以下接口中的文件名都是路径："/" 开头为绝对路径，否则相对于当前目录，可含 "." 与 ".."
+    bool makeDirectory(const std::string& path);
+    bool changeDirectory(const std::string& path);
+    const std::string& getCwd() const { return cwdPath; }
+    // 规范化为绝对路径（纯字符串处理，不检查是否存在）
+    std::string absolutePath(const std::string& path) const;
 
     bool createFile(const std::string& name, int size);
     bool deleteFile(const std::string& name);
+    // 整体替换内容，文件大小变为内容长度
     bool writeFile(const std::string& name, const std::string& content);
     std::string readFile(const std::string& name);
-    void listFiles() const;
-    int getFreeSpace() const;
+
+    // 按偏移读写：代价只与涉及的字节数成正比。
+    // pread 返回读到的字节数（到文件末尾为止），文件不存在返回 -1；
+    // pwrite 写到文件末尾之后时文件自动增长，空间不足返回 -1
+    int pread(const std::string& name, int offset, char* out, int len) const;
+    int pwrite(const std::string& name, int offset, const char* data, int len);
+    // 改变文件大小：缩小时释放尾部的块，增大时新增部分读出为零
+    bool truncate(const std::string& name, int newSize);
+    // 列出目录（或单个文件），逐项输出，不先收集整个目录
+    void listFiles(const std::string& path = ".") const;
+    long long getFreeSpace() const;
+    int getTotalBlocks() const { return blockBitmap.size(); }
     int getFileSize(const std::string& name) const;
 
-    void saveToDisk(const std::string& realFileName) const;
-    void loadFromDisk(const std::string& realFileName);
+    // 按块访问文件（供内存映射使用）：blockNo 为文件内的逻辑块号，buf 为 BLOCK_SIZE 字节
+    int getFileBlockCount(const std::string& name) const;
+    int getPhysicalBlock(const std::string& name, int blockNo) const;
+    bool readFileBlock(const std::string& name, int blockNo, char* buf) const;
+    bool writeFileBlock(const std::string& name, int blockNo, const char* buf);
+
+    // 元数据以二进制格式保存（见 disk_format.h），文件数据已经在磁盘镜像里。
+    // 对同一个元数据文件的再次保存是增量的：只改写脏 inode、变化的位图字与被写过的块的校验和。
+    // 载入只读元数据，块校验和在该块第一次被读时才校验
+    bool saveToDisk(const std::string& realFileName);
+    bool loadFromDisk(const std::string& realFileName);
 
     // 打印磁盘位图状态（用于展示块分配原理）
     void printDiskStatus() const;
 
+    // 写时复制快照：创建时只复制 inode 表并给每个连续段加一次引用，不复制数据块；
+    // 之后写到被共享的块时才为写入方分配新块。回滚把当前文件树换成快照的副本
+    bool createSnapshot(const std::string& name);
+    bool deleteSnapshot(const std::string& name);
+    bool rollbackSnapshot(const std::string& name);
+    void listSnapshots() const;
+
+    // 磁盘 I/O 时间模型：把文件 [offset, offset+len) 涉及的物理块按连续段提交到磁盘请求队列，
+    // 返回提交的请求数（文件不存在返回 -1）。只模拟耗时，数据本身仍由 pread/pwrite 读写
+    int submitIo(const std::string& owner, const std::string& path, int offset, int len, bool write, double now);
+    bool setIoScheduler(const std::string& algorithm);
+    void printIoStatus() const { ioQueue.printStatus(); }
+    int pendingIo() const { return ioQueue.pending(); }
+    double nextIoCompletion() const { return ioQueue.nextCompletion(); }
+
+    // 每个模拟 tick 调用一次：写回过期脏块，推进磁盘请求队列并返回本 tick 完成的请求
+    std::vector<DiskScheduler::Request> tick(int now) {
+        clock = now;
+        cache.tick(now);
+        return ioQueue.advance(now);
+    }
+    void setCacheSize(int blocks) { cache.resize(blocks); }
+    void printCacheStatus() const { cache.printStatus(); }
+
 private:
-    int totalCapacity;
-    std::map<std::string, FileNode> fileSystem; 
+    static constexpr int ROOT_INO = 0;
+    using InodeTable = std::unordered_map<int, FileNode>;
+
+    // 快照：当时 inode 表的副本（inode 号与当前树相同），数据块与当前树共享
+    struct Snapshot {
+        std::string name;
+        int createdAt = 0;
+        InodeTable inodes;
+        int slot = -1;       // 快照头在元数据 inode 表中的记录号
+        bool dirty = true;   // 尚未保存：下次保存时写出整棵树
+    };
+
+    long long totalCapacity;
+    // inode 表：inode 号 -> inode（unordered_map 保证插入后已有元素的引用不失效）
+    InodeTable inodes;
+    int nextIno = ROOT_INO + 1;
+    int cwdIno = ROOT_INO;
+    std::string cwdPath = "/";
+    mutable DentryCache dentries;
+
+    // 位示图：记录哪些块被占用了 (1=占用, 0=空闲)，按 64 位字压缩存放
+    BlockBitmap blockBitmap;
+    DiskImage image;
+    mutable BufferCache cache; // 读路径也会调入/淘汰缓存块
+    DiskScheduler ioQueue;
+    int clock = 0; // 最近一次 tick 的时间，作为快照创建时间
+
+    // 每个物理块被多少个 inode（当前树与各快照）引用；计数降到 0 时才真正释放
+    RefcountMap refs;
+    std::vector<Snapshot> snapshots;
+    long long cowCopies = 0;
+
+    static constexpr int READAHEAD_BLOCKS = 4; // 顺序读时提前调入的块数
+
+    // 路径解析：绝对路径先查目录项缓存，未命中再从根目录逐级查找，失败返回 nullptr
+    FileNode* resolve(const std::string& path);
+    const FileNode* resolve(const std::string& path) const;
+    // 解析普通文件，不存在或是目录时返回 nullptr（report 为真时打印错误）
+    FileNode* findFile(const std::string& path, bool report);
+    const FileNode* findFile(const std::string& path) const;
+    // 解析路径的父目录并检查最后一级名字，用于创建；失败时打印错误
+    FileNode* prepareCreate(const std::string& path, std::string& name);
+    FileNode& addNode(FileNode& dir, const std::string& name, bool isDir);
+    std::string pathOf(const FileNode& node) const;
+
+    // 辅助：文件增长到 blockCount 块，优先紧接最后一段分配
+    bool growBlocks(FileNode& node, int blockCount);
+    // 辅助：文件缩小到 blockCount 块，释放尾部的块
+    void shrinkBlocks(FileNode& node, int blockCount);
+    // 辅助：改变文件大小（不打印信息），空间不足或超过 maxFileSize 返回 false
+    bool resizeFile(FileNode& node, int newSize);
+    // 单个文件的大小上限：整个磁盘的容量（不超过 int 能表示的范围）
+    long long maxFileSize() const {
+        return std::min<long long>(static_cast<long long>(blockBitmap.size()) * BLOCK_SIZE, INT_MAX);
+    }
+    // bytes 字节需要的块数，按 long long 计算避免溢出（bytes 不超过 maxFileSize）
+    static int blocksFor(long long bytes) { return static_cast<int>((bytes + BLOCK_SIZE - 1) / BLOCK_SIZE); }
+    // 辅助：按文件内偏移经块映射读写镜像中的块（data 为空表示写零），写到共享块时先复制
+    void copyOut(const FileNode& node, size_t offset, char* out, size_t len) const;
+    void copyIn(FileNode& node, size_t offset, const char* data, size_t len);
+
+    // 写时复制
+    // 给一段物理块减一次引用，计数降到 0 的块清位并丢弃缓存
+    void dropRefs(int start, int count);
+    // 给一棵树所有文件的连续段加/减一次引用
+    void addTreeRefs(const InodeTable& tree);
+    void dropTreeRefs(const InodeTable& tree);
+    // 写 [offset, offset+len) 需要复制的共享块数，用于写之前检查空间
+    int cowBlocksNeeded(const FileNode& node, size_t offset, size_t len) const;
+    // 把逻辑块 logical 复制到新块并改映射，返回新块号；whole 为真表示随后会整块覆盖，不必复制旧内容
+    int copyOnWrite(FileNode& node, int logical, int phys, bool whole);
+    int sharedBlocksOf(const FileNode& node) const;
+    std::vector<Snapshot>::iterator findSnapshot(const std::string& name);
 
-    // 位示图：记录哪些块被占用了 (true=占用, false=空闲)
-    bool blockBitmap[TOTAL_BLOCKS];
+    // 持久化
+    void verifyBlock(int block) const;
+    void readahead(const FileNode& node, int blockNo) const;
+    void markDirty(int ino) { dirtyFiles.insert(ino); }
+    // 父目录 inode 的第一条记录号（根目录为 -1），子节点记录里存的是它
+    static int parentSlot(const InodeTable& tree, const FileNode& node) {
+        return node.parent == ROOT_INO ? -1 : tree.at(node.parent).slots.front();
+    }
+    int takeSlot();
+    // 释放一棵树占用的所有记录（下次保存时清零）
+    void releaseTreeSlots(const InodeTable& tree);
+    // 给快照头与快照中所有节点分配记录，并按记录号编码出要写的记录
+    std::vector<std::pair<int, diskfmt::InodeRecord>> snapshotRecords(Snapshot& snap);
+    // 由记录还原一棵树的目录结构（父目录缺失或成环的挂到根下），返回修复的节点数
+    int linkTree(InodeTable& tree, const std::unordered_map<int, int>& slotToIno, bool live);
+    bool saveFull(const std::string& realFileName);
 
-    // 辅助：分配块
-    bool allocateBlocks(int size, std::vector<int>& outBlocks);
-    // 辅助：释放块
-    void freeBlocks(const std::vector<int>& blocks);
+    std::string persistedPath;              // 上次保存/载入的元数据文件，增量保存只对它有效
+    std::uint32_t generation = 0;
+    int inodeSlots = 0;                     // 元数据文件中 inode 表的容量
+    int nextSlot = 0;
+    std::vector<int> freeSlots;
+    std::vector<int> releasedSlots;         // 已删除文件留下的记录，下次保存时清零
+    std::set<int> dirtyFiles;
+    std::vector<std::uint64_t> persistedBitmap;
+    std::vector<std::uint32_t> blockChecksums;
+    std::vector<char> blockDirty;           // 上次保存后被写过的块
+    std::vector<int> dirtyBlockList;
+    mutable std::vector<char> blockVerified; // 载入后已校验过（或已重写过）的块
+    mutable long long checksumErrors = 0;
 };
 
 #endif // STORAGE_H
\ No newline at end of file
@@ -0,0 +1,454 @@
+#include "sync_table.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+static const char* kindName(SyncKind kind) {
+    switch (kind) {
+        case SyncKind::Semaphore: return "sem";
+        case SyncKind::Mutex:     return "mutex";
+        case SyncKind::CondVar:   return "cond";
+        case SyncKind::RWLock:    return "rwlock";
+        default:                  return "barrier";
+    }
+}
+
+SyncTable::SyncTable(Scheduler& scheduler) : scheduler(scheduler) {}
+
+SyncStatus SyncTable::create(SyncKind kind, const std::string& name, int value) {
+    if (objects.count(name)) {
+        std::cout << "[Sync] Error: Object '" << name << "' already exists.\n";
+        return SyncStatus::Exists;
+    }
+    SyncObject& obj = objects[name];
+    obj.name = name;
+    obj.kind = kind;
+    obj.value = value;
+    std::cout << "[Sync] Created " << kindName(kind) << " '" << name << "'";
+    if (kind == SyncKind::Semaphore) std::cout << " (value " << value << ")";
+    if (kind == SyncKind::Barrier) std::cout << " (" << value << " parties)";
+    std::cout << ".\n";
+    return SyncStatus::Ok;
+}
+
+SyncTable::SyncObject* SyncTable::find(const std::string& name, SyncKind kind, SyncStatus& status) {
+    auto it = objects.find(name);
+    if (it == objects.end()) {
+        std::cout << "[Sync] Error: " << kindName(kind) << " '" << name << "' not found.\n";
+        status = SyncStatus::NotFound;
+        return nullptr;
+    }
+    if (it->second.kind != kind) {
+        std::cout << "[Sync] Error: '" << name << "' is a " << kindName(it->second.kind) << ", not a "
+                  << kindName(kind) << ".\n";
+        status = SyncStatus::WrongType;
+        return nullptr;
+    }
+    return &it->second;
+}
+
+PCB* SyncTable::current(SyncStatus& status) const {
+    PCB* proc = scheduler.getRunningProcess();
+    if (!proc) {
+        std::cout << "[Error] No running process.\n";
+        status = SyncStatus::NoProcess;
+    }
+    return proc;
+}
+
+/* ================= 等待队列 ================= */
+
+SyncStatus SyncTable::wait(SyncObject& obj, PCB* proc, bool writer, const std::string& mutex) {
+    int now = scheduler.getCurrentTime();
+    std::cout << "[Sync] Process " << proc->pid << " waits on " << kindName(obj.kind) << " '" << obj.name << "'";
+    if (obj.owner) std::cout << " (held by " << obj.owner->pid << ")";
+    std::cout << ", " << obj.waiters.size() + 1 << " waiter(s).\n";
+    unsigned long long token = scheduler.blockCurrentProcess();
+    obj.waiters.push_back({proc, token, now, writer, mutex});
+    obj.contended++;
+    obj.maxWaiters = std::max(obj.maxWaiters, obj.waiters.size());
+    return SyncStatus::Blocked;
+}
+
+void SyncTable::dropStale(SyncObject& obj) {
+    auto stale = [this, &obj](const Waiter& w) {
+        if (live(w)) return false;
+        auto it = blockedOn.find(w.proc);
+        if (it != blockedOn.end() && it->second == obj.name) blockedOn.erase(it);
+        if (obj.kind == SyncKind::Barrier) obj.arrived--; // 离开的进程不再算本轮到达
+        return true;
+    };
+    obj.waiters.erase(std::remove_if(obj.waiters.begin(), obj.waiters.end(), stale), obj.waiters.end());
+}
+
+bool SyncTable::nextWaiter(SyncObject& obj, Waiter& out) {
+    dropStale(obj);
+    if (obj.waiters.empty()) return false;
+    auto best = obj.waiters.begin();
+    if (obj.kind == SyncKind::Mutex) {
+        for (auto it = obj.waiters.begin(); it != obj.waiters.end(); ++it) {
+            if (it->proc->effectivePriority > best->proc->effectivePriority) best = it;
+        }
+    }
+    out = *best;
+    obj.waiters.erase(best);
+    return true;
+}
+
+void SyncTable::recordWait(SyncObject& obj, const Waiter& w) {
+    int waited = scheduler.getCurrentTime() - w.since;
+    obj.waitTicks += waited;
+    obj.maxWait = std::max(obj.maxWait, waited);
+}
+
+void SyncTable::grant(SyncObject& obj, const Waiter& w) {
+    recordWait(obj, w);
+    obj.acquisitions++;
+    std::cout << "[Sync] Process " << w.proc->pid << " gets " << kindName(obj.kind) << " '" << obj.name
+              << "' after waiting " << scheduler.getCurrentTime() - w.since << " tick(s).\n";
+    scheduler.wakeProcess(w.proc);
+}
+
+/* ================= 信号量 ================= */
+
+SyncStatus SyncTable::semWait(const std::string& name) {
+    SyncStatus status = SyncStatus::Ok;
+    PCB* cur = current(status);
+    SyncObject* obj = cur ? find(name, SyncKind::Semaphore, status) : nullptr;
+    if (!obj) return status;
+    if (obj->value > 0) {
+        obj->value--;
+        obj->acquisitions++;
+        std::cout << "[Sync] Process " << cur->pid << " passes sem '" << name << "' (value " << obj->value << ").\n";
+        return SyncStatus::Ok;
+    }
+    return wait(*obj, cur);
+}
+
+SyncStatus SyncTable::semPost(const std::string& name) {
+    SyncStatus status = SyncStatus::Ok;
+    SyncObject* obj = find(name, SyncKind::Semaphore, status);
+    if (!obj) return status;
+    Waiter w;
+    if (nextWaiter(*obj, w)) {
+        grant(*obj, w); // 计数直接交给等待者，值不变
+    } else {
+        obj->value++;
+        std::cout << "[Sync] sem '" << name << "' posted (value " << obj->value << ").\n";
+    }
+    return SyncStatus::Ok;
+}
+
+/* ================= 互斥锁与优先级继承 ================= */
+
+void SyncTable::takeMutex(SyncObject& obj, PCB* proc) {
+    obj.owner = proc;
+    obj.acquiredAt = scheduler.getCurrentTime();
+    blockedOn.erase(proc);
+}
+
+void SyncTable::releaseMutex(SyncObject& obj) {
+    PCB* old = obj.owner;
+    obj.holdTicks += scheduler.getCurrentTime() - obj.acquiredAt;
+    obj.owner = nullptr;
+    Waiter w;
+    if (nextWaiter(obj, w)) {
+        // 直接把锁交给优先级最高的等待者，不让其他进程插队
+        takeMutex(obj, w.proc);
+        grant(obj, w);
+        updatePriority(w.proc);
+    }
+    if (old) updatePriority(old); // 不再持有这把锁，继承来的优先级可能要降回去
+}
+
+SyncStatus SyncTable::lock(const std::string& name) {
+    SyncStatus status = SyncStatus::Ok;
+    PCB* cur = current(status);
+    SyncObject* obj = cur ? find(name, SyncKind::Mutex, status) : nullptr;
+    if (!obj) return status;
+    if (obj->owner == cur) {
+        std::cout << "[Sync] Error: Process " << cur->pid << " already holds mutex '" << name << "'.\n";
+        return SyncStatus::Deadlock;
+    }
+    if (obj->owner && obj->owner->state == FINISHED) {
+        std::cout << "[Sync] Owner " << obj->owner->pid << " of mutex '" << name << "' finished, lock recovered.\n";
+        releaseMutex(*obj); // 有等待者时交给它，否则下面由当前进程获得
+    }
+    if (!obj->owner) {
+        takeMutex(*obj, cur);
+        obj->acquisitions++;
+        std::cout << "[Sync] Process " << cur->pid << " locked mutex '" << name << "'.\n";
+        return SyncStatus::Ok;
+    }
+    blockedOn[cur] = name;
+    SyncStatus s = wait(*obj, cur);
+    updatePriority(obj->owner); // 持锁者继承等待者的优先级
+    return s;
+}
+
+SyncStatus SyncTable::unlock(const std::string& name) {
+    SyncStatus status = SyncStatus::Ok;
+    PCB* cur = current(status);
+    SyncObject* obj = cur ? find(name, SyncKind::Mutex, status) : nullptr;
+    if (!obj) return status;
+    if (obj->owner != cur) {
+        std::cout << "[Sync] Error: Process " << cur->pid << " does not hold mutex '" << name << "'.\n";
+        return SyncStatus::NotOwner;
+    }
+    std::cout << "[Sync] Process " << cur->pid << " unlocked mutex '" << name << "'.\n";
+    releaseMutex(*obj);
+    return SyncStatus::Ok;
+}
+
+int SyncTable::inheritedPriority(PCB* proc) const {
+    int priority = proc->priority;
+    for (const auto& pair : objects) {
+        const SyncObject& obj = pair.second;
+        if (obj.kind != SyncKind::Mutex || obj.owner != proc) continue;
+        for (const Waiter& w : obj.waiters) {
+            if (live(w)) priority = std::max(priority, w.proc->effectivePriority);
+        }
+    }
+    return priority;
+}
+
+void SyncTable::updatePriority(PCB* proc, int depth) {
+    // 深度限制防止锁的等待链成环（死锁）时无限递归
+    if (!proc || depth > static_cast<int>(objects.size())) return;
+    int priority = inheritedPriority(proc);
+    int old = proc->effectivePriority;
+    if (priority == old) return;
+    proc->effectivePriority = priority;
+    if (priority > proc->priority) {
+        std::cout << "[Sync] Priority inheritance: " << proc->pid << " runs at priority " << priority << " (base "
+                  << proc->priority << ").\n";
+    } else if (old > priority) {
+        std::cout << "[Sync] " << proc->pid << " back to base priority " << priority << ".\n";
+    }
+    // 它自己也在等锁：沿等待链把优先级继续传给那把锁的持有者
+    auto it = blockedOn.find(proc);
+    if (it == blockedOn.end()) return;
+    auto obj = objects.find(it->second);
+    bool waiting = obj != objects.end() &&
+                   std::any_of(obj->second.waiters.begin(), obj->second.waiters.end(),
+                               [proc](const Waiter& w) { return w.proc == proc && live(w); });
+    if (!waiting) {
+        blockedOn.erase(it); // 已被别处唤醒，不再等这把锁
+        return;
+    }
+    updatePriority(obj->second.owner, depth + 1);
+}
+
+void SyncTable::setPriority(PCB* proc, int priority) {
+    proc->priority = priority;
+    updatePriority(proc);
+}
+
+/* ================= 条件变量 ================= */
+
+SyncStatus SyncTable::condWait(const std::string& cond, const std::string& mutex) {
+    SyncStatus status = SyncStatus::Ok;
+    PCB* cur = current(status);
+    SyncObject* c = cur ? find(cond, SyncKind::CondVar, status) : nullptr;
+    SyncObject* m = c ? find(mutex, SyncKind::Mutex, status) : nullptr;
+    if (!m) return status;
+    if (m->owner != cur) {
+        std::cout << "[Sync] Error: cond_wait requires holding mutex '" << mutex << "'.\n";
+        return SyncStatus::NotOwner;
+    }
+    std::cout << "[Sync] Process " << cur->pid << " releases mutex '" << mutex << "' to wait on cond '" << cond << "'.\n";
+    releaseMutex(*m);
+    return wait(*c, cur, false, mutex);
+}
+
+SyncStatus SyncTable::condSignal(const std::string& cond, bool broadcast) {
+    SyncStatus status = SyncStatus::Ok;
+    SyncObject* c = find(cond, SyncKind::CondVar, status);
+    if (!c) return status;
+    int woken = 0;
+    Waiter w;
+    while (nextWaiter(*c, w)) {
+        woken++;
+        auto m = objects.find(w.mutex);
+        if (m == objects.end() || m->second.owner == nullptr) {
+            // 互斥锁空闲：重新持有后即可运行
+            if (m != objects.end()) {
+                takeMutex(m->second, w.proc);
+                m->second.acquisitions++;
+            }
+            grant(*c, w);
+        } else {
+            // 互斥锁被占用：从条件变量转到互斥锁的等待队列，仍然阻塞
+            recordWait(*c, w);
+            c->acquisitions++;
+            SyncObject& mutex = m->second;
+            mutex.waiters.push_back({w.proc, w.token, scheduler.getCurrentTime(), false, ""}); // 仍是同一次阻塞
+            mutex.contended++;
+            mutex.maxWaiters = std::max(mutex.maxWaiters, mutex.waiters.size());
+            blockedOn[w.proc] = mutex.name;
+            std::cout << "[Sync] Process " << w.proc->pid << " signaled on cond '" << cond << "', now waits for mutex '"
+                      << mutex.name << "'.\n";
+            updatePriority(mutex.owner);
+        }
+        if (!broadcast) break;
+    }
+    if (woken == 0) std::cout << "[Sync] cond '" << cond << "' has no waiters, signal lost.\n";
+    return SyncStatus::Ok;
+}
+
+/* ================= 读写锁 ================= */
+
+SyncStatus SyncTable::readLock(const std::string& name) {
+    SyncStatus status = SyncStatus::Ok;
+    PCB* cur = current(status);
+    SyncObject* obj = cur ? find(name, SyncKind::RWLock, status) : nullptr;
+    if (!obj) return status;
+    if (obj->owner == cur || std::count(obj->readers.begin(), obj->readers.end(), cur)) {
+        std::cout << "[Sync] Error: Process " << cur->pid << " already holds rwlock '" << name << "'.\n";
+        return SyncStatus::Deadlock;
+    }
+    dropStale(*obj);
+    // 有写者在等时新读者也排队，避免写者饥饿
+    bool writerWaiting = std::any_of(obj->waiters.begin(), obj->waiters.end(), [](const Waiter& w) { return w.writer; });
+    if (!obj->owner && !writerWaiting) {
+        obj->readers.push_back(cur);
+        obj->acquisitions++;
+        std::cout << "[Sync] Process " << cur->pid << " read-locked '" << name << "' (" << obj->readers.size()
+                  << " reader(s)).\n";
+        return SyncStatus::Ok;
+    }
+    return wait(*obj, cur, false);
+}
+
+SyncStatus SyncTable::writeLock(const std::string& name) {
+    SyncStatus status = SyncStatus::Ok;
+    PCB* cur = current(status);
+    SyncObject* obj = cur ? find(name, SyncKind::RWLock, status) : nullptr;
+    if (!obj) return status;
+    if (obj->owner == cur || std::count(obj->readers.begin(), obj->readers.end(), cur)) {
+        std::cout << "[Sync] Error: Process " << cur->pid << " already holds rwlock '" << name << "'.\n";
+        return SyncStatus::Deadlock;
+    }
+    if (!obj->owner && obj->readers.empty()) {
+        obj->owner = cur;
+        obj->acquiredAt = scheduler.getCurrentTime();
+        obj->acquisitions++;
+        std::cout << "[Sync] Process " << cur->pid << " write-locked '" << name << "'.\n";
+        return SyncStatus::Ok;
+    }
+    return wait(*obj, cur, true);
+}
+
+SyncStatus SyncTable::rwUnlock(const std::string& name) {
+    SyncStatus status = SyncStatus::Ok;
+    PCB* cur = current(status);
+    SyncObject* obj = cur ? find(name, SyncKind::RWLock, status) : nullptr;
+    if (!obj) return status;
+    auto reader = std::find(obj->readers.begin(), obj->readers.end(), cur);
+    if (obj->owner == cur) {
+        obj->holdTicks += scheduler.getCurrentTime() - obj->acquiredAt;
+        obj->owner = nullptr;
+    } else if (reader != obj->readers.end()) {
+        obj->readers.erase(reader);
+    } else {
+        std::cout << "[Sync] Error: Process " << cur->pid << " does not hold rwlock '" << name << "'.\n";
+        return SyncStatus::NotOwner;
+    }
+    std::cout << "[Sync] Process " << cur->pid << " unlocked rwlock '" << name << "'.\n";
+    admitRW(*obj);
+    return SyncStatus::Ok;
+}
+
+// 按到达顺序放行：队首连续的读者一起进入；队首是写者时等所有读者离开后单独进入
+void SyncTable::admitRW(SyncObject& obj) {
+    dropStale(obj);
+    while (!obj.owner && !obj.waiters.empty()) {
+        Waiter w = obj.waiters.front();
+        if (w.writer) {
+            if (!obj.readers.empty()) break;
+            obj.waiters.pop_front();
+            obj.owner = w.proc;
+            obj.acquiredAt = scheduler.getCurrentTime();
+            grant(obj, w);
+            break;
+        }
+        obj.waiters.pop_front();
+        obj.readers.push_back(w.proc);
+        grant(obj, w);
+    }
+}
+
+/* ================= 屏障 ================= */
+
+SyncStatus SyncTable::barrierWait(const std::string& name) {
+    SyncStatus status = SyncStatus::Ok;
+    PCB* cur = current(status);
+    SyncObject* obj = cur ? find(name, SyncKind::Barrier, status) : nullptr;
+    if (!obj) return status;
+    dropStale(*obj); // 先去掉本轮中已被别处唤醒的进程，到达计数才准确
+    obj->arrived++;
+    if (obj->arrived < obj->value) return wait(*obj, cur);
+
+    // 最后一个到达者放行本轮所有等待者，自己不阻塞
+    std::cout << "[Sync] Barrier '" << name << "' complete (" << obj->arrived << "/" << obj->value << "), releasing.\n";
+    obj->arrived = 0;
+    obj->acquisitions++;
+    Waiter w;
+    while (nextWaiter(*obj, w)) grant(*obj, w);
+    return SyncStatus::Ok;
+}
+
+/* ================= 统计 ================= */
+
+void SyncTable::printStatus() const {
+    std::cout << "\n--- Sync Objects (by total wait time) ---\n";
+    if (objects.empty()) {
+        std::cout << "(No objects)\n";
+        std::cout << "-----------------------------------------\n";
+        return;
+    }
+    std::vector<const SyncObject*> sorted;
+    for (const auto& pair : objects) sorted.push_back(&pair.second);
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const SyncObject* a, const SyncObject* b) { return a->waitTicks > b->waitTicks; });
+
+    std::cout << std::left << std::setw(12) << "Name" << std::setw(9) << "Type" << std::setw(22) << "State"
+              << std::right << std::setw(6) << "Acq" << std::setw(8) << "Waited" << std::setw(9) << "WaitSum"
+              << std::setw(9) << "WaitAvg" << std::setw(8) << "MaxW" << std::setw(9) << "MaxQ" << std::setw(7)
+              << "Hold" << "\n";
+    std::cout << std::fixed << std::setprecision(2);
+    for (const SyncObject* obj : sorted) {
+        size_t waiting = 0;
+        for (const Waiter& w : obj->waiters) {
+            if (live(w)) waiting++;
+        }
+        std::string state;
+        switch (obj->kind) {
+            case SyncKind::Semaphore: state = "value " + std::to_string(obj->value); break;
+            case SyncKind::Mutex:
+                state = obj->owner ? "held by " + obj->owner->pid + " (p" + std::to_string(obj->owner->effectivePriority) + ")"
+                                   : "free";
+                break;
+            case SyncKind::RWLock:
+                state = obj->owner ? "writer " + obj->owner->pid
+                                   : (obj->readers.empty() ? "free" : std::to_string(obj->readers.size()) + " reader(s)");
+                break;
+            case SyncKind::Barrier: {
+                // 已被别处唤醒的等待者要到下次操作屏障时才移除，这里先不计入
+                int arrived = obj->arrived - static_cast<int>(obj->waiters.size() - waiting);
+                state = std::to_string(arrived) + "/" + std::to_string(obj->value) + " arrived";
+                break;
+            }
+            default: state = "-"; break;
+        }
+        if (waiting > 0) state += ", " + std::to_string(waiting) + " waiting";
+        std::cout << std::left << std::setw(12) << obj->name << std::setw(9) << kindName(obj->kind) << std::setw(22)
+                  << state << std::right << std::setw(6) << obj->acquisitions << std::setw(8) << obj->contended
+                  << std::setw(9) << obj->waitTicks << std::setw(9)
+                  << (obj->contended > 0 ? static_cast<double>(obj->waitTicks) / obj->contended : 0.0) << std::setw(8)
+                  << obj->maxWait << std::setw(9) << obj->maxWaiters << std::setw(7) << obj->holdTicks << "\n";
+    }
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6) << std::left;
+    std::cout << "-----------------------------------------\n";
+}
@@ -0,0 +1,115 @@
+// sync/sync_table.h
+#ifndef SYNC_TABLE_H
+#define SYNC_TABLE_H
+
+#include <string>
+#include <map>
+#include <deque>
+#include <vector>
+#include "../scheduler/scheduler.h"
+
+enum class SyncKind {
+    Semaphore,
+    Mutex,
+    CondVar,
+    RWLock,
+    Barrier
+};
+
+// 同步操作的结果
+enum class SyncStatus {
+    Ok,
+    Blocked,   // 当前进程已阻塞，稍后由释放者唤醒
+    NotFound,
+    Exists,
+    WrongType, // 对象存在但类型不对
+    NotOwner,  // 释放了不属于自己的锁
+    Deadlock,  // 对自己已持有的互斥锁再次加锁
+    NoProcess  // 没有正在运行的进程
+};
+
+// 内核同步对象表：按名字管理信号量、互斥锁、条件变量、读写锁与屏障，
+// 所有等待都经 Scheduler::blockCurrentProcess / wakeProcess 实现。
+// 互斥锁有属主并支持优先级继承：高优先级进程等锁时，持锁者（以及它所等待的锁的持锁者，沿链传递）
+// 临时以等待者的优先级运行，解锁后恢复。每个对象都记录竞争统计，用来找出让负载串行化的锁
+class SyncTable {
+public:
+    explicit SyncTable(Scheduler& scheduler);
+
+    // value：信号量初值 / 屏障的参与进程数，其他对象忽略
+    SyncStatus create(SyncKind kind, const std::string& name, int value);
+
+    // 以下操作都由当前运行的进程发起
+    SyncStatus semWait(const std::string& name);
+    SyncStatus semPost(const std::string& name);
+    SyncStatus lock(const std::string& name);
+    SyncStatus unlock(const std::string& name);
+    // 原子地释放 mutex 并在 cond 上等待；被唤醒后重新持有 mutex 才继续运行
+    SyncStatus condWait(const std::string& cond, const std::string& mutex);
+    SyncStatus condSignal(const std::string& cond, bool broadcast);
+    SyncStatus readLock(const std::string& name);
+    SyncStatus writeLock(const std::string& name);
+    SyncStatus rwUnlock(const std::string& name);
+    SyncStatus barrierWait(const std::string& name);
+
+    // 设置进程的基础优先级，并按它当前持有的锁重新计算继承后的有效优先级
+    void setPriority(PCB* proc, int priority);
+
+    // 对象表与竞争统计，按总等待时间从高到低排列
+    void printStatus() const;
+
+private:
+    struct Waiter {
+        PCB* proc;
+        unsigned long long token; // 阻塞时得到的等待令牌
+        int since;
+        bool writer;       // 读写锁：等的是写锁
+        std::string mutex; // 条件变量：唤醒后要重新获取的互斥锁
+    };
+
+    struct SyncObject {
+        std::string name;
+        SyncKind kind;
+        int value = 0;            // 信号量计数 / 屏障参与数
+        PCB* owner = nullptr;     // 互斥锁属主 / 读写锁的写者
+        std::vector<PCB*> readers;
+        int arrived = 0;          // 屏障：本轮已到达的进程数
+        std::deque<Waiter> waiters;
+
+        // 竞争统计
+        long long acquisitions = 0;
+        long long contended = 0;  // 需要等待才得到的次数
+        long long waitTicks = 0;
+        int maxWait = 0;
+        size_t maxWaiters = 0;
+        long long holdTicks = 0;  // 互斥锁/写锁被持有的总时间
+        int acquiredAt = 0;
+    };
+
+    SyncObject* find(const std::string& name, SyncKind kind, SyncStatus& status);
+    PCB* current(SyncStatus& status) const;
+    // 当前进程加入 obj 的等待队列并阻塞
+    SyncStatus wait(SyncObject& obj, PCB* proc, bool writer = false, const std::string& mutex = "");
+    // 仍在等这个对象：进程阻塞着，且从入队起没有被别处唤醒过
+    static bool live(const Waiter& w) { return w.proc->waitingOn(w.token); }
+    // 去掉已被别处唤醒（wake 命令、IPC、I/O 完成）或已结束的等待者；屏障同时减掉它们的到达计数
+    void dropStale(SyncObject& obj);
+    // 取出下一个等待者，互斥锁按有效优先级选取（同优先级先来先得），其他对象按 FIFO
+    bool nextWaiter(SyncObject& obj, Waiter& out);
+    void recordWait(SyncObject& obj, const Waiter& w);
+    // 等待者得到对象：记录等待时间并唤醒
+    void grant(SyncObject& obj, const Waiter& w);
+    void takeMutex(SyncObject& obj, PCB* proc);
+    void releaseMutex(SyncObject& obj);
+    void admitRW(SyncObject& obj);
+
+    // 优先级继承
+    int inheritedPriority(PCB* proc) const;
+    void updatePriority(PCB* proc, int depth = 0);
+
+    Scheduler& scheduler;
+    std::map<std::string, SyncObject> objects;
+    std::map<PCB*, std::string> blockedOn; // 等待互斥锁的进程 -> 锁名，用于沿链传递继承的优先级（使用前核对仍在等待）
+};
+
+#endif // SYNC_TABLE_H